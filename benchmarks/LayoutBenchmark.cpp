@@ -0,0 +1,152 @@
+/* This file is part of JCyberEvolution.
+
+JCyberEvolution is free software: you can redistribute it and/or modify it 
+under the terms of the GNU General Public License as published by the Free Software Foundation, 
+either version 3 of the License, or (at your option) any later version.
+
+JCyberEvolution is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with JCyberEvolution. 
+If not, see <https://www.gnu.org/licenses/>. */
+
+
+// times epochs of a dense and of a sparse field with the cell layout this build was configured with,
+// run it once from a build with MORTON_CELL_ORDER and once from one without to compare the layouts,
+// cache misses are counted by the hardware counters where Linux exposes them
+
+#include "Field.h"
+#include "Topology.h"
+
+#include <SFML/System.hpp>
+using sf::Clock;
+
+#include <iostream>
+using std::cout;
+using std::endl;
+
+#include <cstdlib>
+#include <cstdint>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#endif
+
+// cache misses of this thread and of threads it starts after the counter is created,
+// misses of a started thread are added when it exits
+class CacheMissCounter {
+public:
+    CacheMissCounter() noexcept : m_file{-1} {
+#ifdef __linux__
+        perf_event_attr attributes;
+        memset(&attributes, 0, sizeof(attributes));
+        attributes.size = sizeof(attributes);
+        attributes.type = PERF_TYPE_HARDWARE;
+        attributes.config = PERF_COUNT_HW_CACHE_MISSES;
+        attributes.disabled = 1;
+        attributes.inherit = 1;
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+        m_file = static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+#endif
+    }
+
+    ~CacheMissCounter() {
+#ifdef __linux__
+        if (isAvailable()) close(m_file);
+#endif
+    }
+
+    CacheMissCounter(const CacheMissCounter&) = delete;
+    CacheMissCounter& operator= (const CacheMissCounter&) = delete;
+
+    // no hardware counters, or not allowed to use them
+    bool isAvailable() const noexcept {
+        return m_file >= 0;
+    }
+
+    void start() noexcept {
+#ifdef __linux__
+        if (isAvailable()) ioctl(m_file, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+
+    void stop() noexcept {
+#ifdef __linux__
+        if (isAvailable()) ioctl(m_file, PERF_EVENT_IOC_DISABLE, 0);
+#endif
+    }
+
+    uint64_t getCount() const noexcept {
+        uint64_t count = 0;
+#ifdef __linux__
+        if (isAvailable() && read(m_file, &count, sizeof(count)) != sizeof(count)) count = 0;
+#endif
+        return count;
+    }
+private:
+    int m_file;
+};
+
+static constexpr uint64_t SEED = 1;
+static constexpr int REPEATS = 3;
+
+struct Workload {
+    int size;
+    float density;
+    int epochs;
+};
+
+struct Result {
+    float seconds;
+    uint64_t cacheMisses;
+};
+
+static Result measure(const Workload& workload) {
+    // created before the field, so misses of the workers of its pool are counted too
+    CacheMissCounter counter;
+    Result result{};
+    {
+        Field field{workload.size, workload.size, SEED};
+        field.setTopology(Topology::createTopology(Topology::Id::TORUS, workload.size, workload.size));
+        field.randomFill(workload.density);
+
+        counter.start();
+        Clock clock;
+        for (int epoch = 0; epoch < workload.epochs; ++ epoch)
+            field.update();
+        result.seconds = clock.getElapsedTime().asSeconds();
+        counter.stop();
+    }
+    result.cacheMisses = counter.getCount();
+    return result;
+}
+
+int main() {
+#ifdef MORTON_CELL_ORDER
+    cout << "cells of chunks in Z-order" << endl;
+#else
+    cout << "cells of chunks row by row" << endl;
+#endif
+    bool countsMisses = CacheMissCounter{}.isAvailable();
+    if (!countsMisses) cout << "cache misses can't be counted here" << endl;
+
+    for (const Workload& workload : {Workload{1024, 0.5f, 30}, Workload{4096, 0.01f, 10}}) {
+        Result best{1e9f, 0};
+        for (int repeat = 0; repeat < REPEATS; ++ repeat) {
+            Result result = measure(workload);
+            if (result.seconds < best.seconds) best = result;
+        }
+        cout << workload.size << "x" << workload.size << ", density " 
+             << workload.density << ", " << workload.epochs << " epochs: " 
+             << best.seconds << " s";
+        if (countsMisses) cout << ", " << best.cacheMisses << " cache misses";
+        cout << ", best of " << REPEATS << endl;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,165 @@
+/* This file is part of JCyberEvolution.
+
+JCyberEvolution is free software: you can redistribute it and/or modify it 
+under the terms of the GNU General Public License as published by the Free Software Foundation, 
+either version 3 of the License, or (at your option) any later version.
+
+JCyberEvolution is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with JCyberEvolution. 
+If not, see <https://www.gnu.org/licenses/>. */
+
+
+// compares decisions per second of the scalar interpreter and the lockstep one,
+// both paths draw the same random numbers, so they run the same simulation;
+// lockstep pays off when many bots share a genome, so the population mix is varied
+
+#include "Field.h"
+#include "Topology.h"
+
+#include <SFML/System.hpp>
+using sf::Clock;
+
+#include <iostream>
+using std::cout;
+using std::endl;
+
+#include <algorithm>
+using std::max;
+using std::min;
+
+#include <memory>
+using std::make_unique;
+
+#include <vector>
+using std::vector;
+
+#include <cstdlib>
+
+static constexpr uint64_t SEED = 1;
+static constexpr int EPOCHS = 200;
+static constexpr int REPEATS = 3;
+static constexpr int MIXED_SPECIES = 8;
+// codes before the eat, short enough that the instruction cost is paid by grazing
+static constexpr int CHAIN_LENGTH = 32;
+
+enum class Mix {
+    // random genomes, nearly every bot its own species
+    RANDOM,
+    // one species with a jump chain genome
+    MONOCULTURE,
+    // a few chain genomes and a few random ones, interleaved in space
+    MIXED,
+};
+
+static const char* getName(Mix mix) noexcept {
+    switch (mix) {
+    case Mix::RANDOM: return "random";
+    case Mix::MONOCULTURE: return "monoculture";
+    case Mix::MIXED: return "mixed";
+    }
+    return "";
+}
+
+static uint16_t encode(Bot::Instruction instruction, uint16_t argument) noexcept {
+    return static_cast<uint16_t>(instruction) | argument;
+}
+
+// long runs of relative jumps with a rotation every few steps, then eat and start over;
+// variant shifts the rotation period, so variants are different species with the same shape
+static Species createChain(int variant, sf::Color color) noexcept {
+    Species species{color};
+    int period = 8 + 2 * variant;
+    for (int i = 0; i < CHAIN_LENGTH; i += 2) {
+        if (i % period == 0) {
+            species[i] = encode(Bot::Instruction::ROTATE, 0);
+            species[i + 1] = (1 << 4) | 1;
+        } else {
+            species[i] = encode(Bot::Instruction::JMP, 0);
+            species[i + 1] = (1 << 9) | 2;
+        }
+    }
+    species[CHAIN_LENGTH] = encode(Bot::Instruction::EAT, 0);
+    species[CHAIN_LENGTH + 1] = encode(Bot::Instruction::JMP, 0);
+    species[CHAIN_LENGTH + 2] = (1 << 8) | 0;
+    return species;
+}
+
+static void fill(Field& field, Mix mix) {
+    if (mix == Mix::RANDOM) {
+        field.randomFill(0.5f);
+        return;
+    }
+
+    // designed populations stay designed
+    field.getSettings().mutationChance = 0.f;
+
+    SpeciesStore& store = field.getSpeciesStore();
+    RandomBuffer& randomBuffer = field.getRandomBuffer();
+    vector<SpeciesHandle> handles;
+    if (mix == Mix::MONOCULTURE) {
+        handles.push_back(store.create(createChain(0, sf::Color::Green)));
+    } else {
+        for (int variant = 0; variant < MIXED_SPECIES / 2; ++ variant) 
+            handles.push_back(store.create(createChain(variant, sf::Color::Green)));
+        for (int i = 0; i < MIXED_SPECIES / 2; ++ i) 
+            handles.push_back(store.createRandom(randomBuffer));
+    }
+
+    for (int y = 0; y < field.getHeight(); ++ y) {
+        for (int x = 0; x < field.getWidth(); ++ x) {
+            if (randomBuffer.getBelow(2) != 0) continue;
+            SpeciesHandle species = handles[randomBuffer.getBelow(static_cast<uint32_t>(handles.size()))];
+            int rotation = static_cast<int>(randomBuffer.getBelow(8));
+            field.placeBot(x, y, make_unique<Bot>(sf::Vector2i{x, y}, rotation, 10.0, species));
+        }
+    }
+}
+
+struct Result {
+    // mean of the decision phase rates of all epochs
+    double decisionsPerSecond = 0.0;
+    float seconds = 0.f;
+};
+
+static Result measure(int size, Mix mix, bool lockstep) {
+    Field field{size, size, SEED};
+    field.setTopology(Topology::createTopology(Topology::Id::TORUS, size, size));
+    field.getSettings().lockstepDecisions = lockstep;
+    fill(field, mix);
+
+    Result result;
+    Clock clock;
+    for (int epoch = 0; epoch < EPOCHS; ++ epoch) {
+        field.update();
+        result.decisionsPerSecond += field.computeStatistics().decisionsPerSecond / EPOCHS;
+    }
+    result.seconds = clock.getElapsedTime().asSeconds();
+    return result;
+}
+
+int main() {
+    for (Mix mix : {Mix::RANDOM, Mix::MONOCULTURE, Mix::MIXED}) {
+        for (int size : {128, 256}) {
+            Result scalar{0.0, 1e9f};
+            Result lockstep{0.0, 1e9f};
+            for (int repeat = 0; repeat < REPEATS; ++ repeat) {
+                for (bool isLockstep : {false, true}) {
+                    Result result = measure(size, mix, isLockstep);
+                    Result& best = isLockstep ? lockstep : scalar;
+                    best.decisionsPerSecond = max(best.decisionsPerSecond, result.decisionsPerSecond);
+                    best.seconds = min(best.seconds, result.seconds);
+                }
+            }
+            cout << getName(mix) << ", " << size << "x" << size << ", " 
+                 << EPOCHS << " epochs, best of " << REPEATS << endl;
+            cout << "  scalar:   " << scalar.decisionsPerSecond / 1e6 << "M decisions/s, " 
+                 << scalar.seconds << " s" << endl;
+            cout << "  lockstep: " << lockstep.decisionsPerSecond / 1e6 << "M decisions/s, " 
+                 << lockstep.seconds << " s" << endl;
+        }
+    }
+    return EXIT_SUCCESS;
+}
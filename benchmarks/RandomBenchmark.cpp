@@ -0,0 +1,89 @@
+/* This file is part of JCyberEvolution.
+
+JCyberEvolution is free software: you can redistribute it and/or modify it 
+under the terms of the GNU General Public License as published by the Free Software Foundation, 
+either version 3 of the License, or (at your option) any later version.
+
+JCyberEvolution is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with JCyberEvolution. 
+If not, see <https://www.gnu.org/licenses/>. */
+
+
+// compares bounded draws from the RandomBuffer with std::uniform_int_distribution
+// on the mt19937_64 the field used before, and times randomFill which draws the most
+
+#include "RandomBuffer.h"
+#include "Field.h"
+#include "Topology.h"
+
+#include <SFML/System.hpp>
+using sf::Clock;
+
+#include <random>
+using std::mt19937_64;
+using std::uniform_int_distribution;
+
+#include <iostream>
+using std::cout;
+using std::endl;
+
+#include <algorithm>
+using std::min;
+
+#include <cstdlib>
+#include <cstdint>
+
+static constexpr int DRAWS = 50'000'000;
+static constexpr int REPEATS = 3;
+static constexpr int FILL_SIZE = 512;
+
+// sum of all draws, printed so the loops can't be optimized away
+static uint64_t checksum = 0;
+
+// nanoseconds per draw, best of the repeats
+template <typename Draw>
+static double measure(Draw&& draw) {
+    double best = 1e9;
+    for (int repeat = 0; repeat < REPEATS; ++ repeat) {
+        uint64_t sum = 0;
+        Clock clock;
+        for (int i = 0; i < DRAWS; ++ i)
+            sum += draw();
+        best = min(best, clock.getElapsedTime().asMicroseconds() * 1e3 / DRAWS);
+        checksum += sum;
+    }
+    return best;
+}
+
+// ranges are constants as in the simulation, so both sides can fold them
+template <uint32_t RANGE>
+static void compare(mt19937_64& engine, RandomBuffer& buffer) {
+    uniform_int_distribution<uint32_t> distribution{0, RANGE - 1};
+    cout << "0.." << RANGE - 1 << ":" << endl;
+    cout << "  mt19937_64:   " << measure([&] { return distribution(engine); }) << " ns" << endl;
+    cout << "  RandomBuffer: " << measure([&] { return buffer.getBelow(RANGE); }) << " ns" << endl;
+}
+
+int main() {
+    mt19937_64 engine{1};
+    RandomBuffer buffer{1};
+    compare<7>(engine, buffer);
+    compare<8>(engine, buffer);
+    compare<256>(engine, buffer);
+
+    float best = 1e9f;
+    for (int repeat = 0; repeat < REPEATS; ++ repeat) {
+        Field field{FILL_SIZE, FILL_SIZE, 1};
+        field.setTopology(Topology::createTopology(Topology::Id::TORUS, FILL_SIZE, FILL_SIZE));
+        Clock clock;
+        field.randomFill(0.5f);
+        best = min(best, clock.getElapsedTime().asSeconds());
+    }
+    cout << "randomFill of " << FILL_SIZE << "x" << FILL_SIZE << " at density 0.5: " 
+         << best << " s, best of " << REPEATS << endl;
+    cout << "checksum " << checksum << endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,51 @@
+/* This file is part of JCyberEvolution.
+
+JCyberEvolution is free software: you can redistribute it and/or modify it 
+under the terms of the GNU General Public License as published by the Free Software Foundation, 
+either version 3 of the License, or (at your option) any later version.
+
+JCyberEvolution is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with JCyberEvolution. 
+If not, see <https://www.gnu.org/licenses/>. */
+
+#include "AllocationCounter.h"
+
+#include <atomic>
+using std::atomic;
+using std::memory_order_relaxed;
+
+#include <cstdlib>
+using std::malloc;
+using std::free;
+
+#include <new>
+using std::bad_alloc;
+
+static atomic<uint64_t> allocationCount{0};
+
+#ifdef COUNT_ALLOCATIONS
+// array and nothrow forms call these by default
+void* operator new(std::size_t size) {
+    allocationCount.fetch_add(1, memory_order_relaxed);
+    if (void* pointer = malloc(size > 0 ? size : 1)) return pointer;
+    throw bad_alloc{};
+}
+
+void operator delete(void* pointer) noexcept {
+    free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept {
+    free(pointer);
+}
+#endif
+
+AllocationCounter::AllocationCounter() noexcept : 
+    m_start{allocationCount.load(memory_order_relaxed)} {}
+
+uint64_t AllocationCounter::getCount() const noexcept {
+    return allocationCount.load(memory_order_relaxed) - m_start;
+}
@@ -17,6 +17,8 @@ If not, see <https://www.gnu.org/licenses/>. */
 #include "utility.h"
 #include "Decision.h"
 #include "Topology.h"
+#include "Pool.h"
+#include "RandomBuffer.h"
 
 #include <SFML/Graphics.hpp>
 using sf::Vector2f;
@@ -25,247 +27,473 @@ using sf::Color;
 using sf::RenderTarget;
 using sf::RenderStates;
 
-#include <random>
-using std::mt19937_64;
-
 #include <algorithm>
 using std::min;
 
-#include <memory>
-using std::shared_ptr;
-using std::make_shared;
-using std::uniform_int_distribution;
+#include <utility>
+using std::as_const;
 
 #include <cassert>
 
-Bot::Bot() noexcept : Bot({0, 0}, 0, 0.0, nullptr) {}
+using BotPool = Pool<sizeof(Bot), alignof(Bot)>;
 
-Bot::Bot(Vector2i position, int rotation, double energy, shared_ptr<Species> species) noexcept : 
-        m_instructionPointer{0}, m_age{0}, m_energy{energy},  m_kills{0}, m_eats{0},
-        m_position{position}, m_directionShape{{0.1f, 0.3f}} {
-    setSpecies(species);
+void* Bot::operator new(std::size_t size) {
+    assert(size == sizeof(Bot));
+    return BotPool::getInstance().allocate();
+}
+
+void Bot::operator delete(void* pointer) noexcept {
+    BotPool::getInstance().deallocate(pointer);
+}
 
-    m_directionShape.setOrigin(0.05f, 0.05f);
-    m_directionShape.setPosition(position.x + 0.5f, position.y + 0.5f);
-    setRotation(rotation);
+Bot::Bot() noexcept : Bot({0, 0}, 0, 0.0, SpeciesHandle{}) {}
+
+Bot::Bot(Vector2i position, int rotation, double energy, SpeciesHandle species) noexcept : 
+        m_id{0}, m_instructionPointer{0}, m_age{0}, m_energy{energy},  m_kills{0}, m_eats{0},
+        m_position{position}, m_rotation{rotation} {
+    setSpecies(species);
 }
 
-int Bot::decodeRotation(uint16_t code, mt19937_64& randomEngine) const noexcept {
+int Bot::decodeRotation(uint16_t code, RandomBuffer& randomBuffer) const noexcept {
     if (code & (1 << 4)) {
         return (getRotation() + code % 8) % 8;
     } else {
         if (code & (1 << 3)) {
             return code % 8;
         } else {
-            return uniform_int_distribution(0, 7)(randomEngine);
+            return static_cast<int>(randomBuffer.getBelow(8));
         }
     }
 }
 
-int Bot::decodeAddress(uint16_t code, mt19937_64& randomEngine) const noexcept {
+int Bot::decodeAddress(uint16_t code, RandomBuffer& randomBuffer) const noexcept {
     if (code & (1 << 9)) {
         return (m_instructionPointer + code % 256) % 256;
     } else {
         if (code & (1 << 8)) {
             return code % 256;
         } else {
-            return uniform_int_distribution(0, 255)(randomEngine);
+            return static_cast<int>(randomBuffer.getBelow(256));
         }
     }
 }
 
-void Bot::executeTest(bool condition, mt19937_64& randomEngine) noexcept {
+void Bot::executeTest(bool condition, const Species& species, RandomBuffer& randomBuffer) noexcept {
     if (condition) {
         m_instructionPointer 
-            = decodeAddress((*m_species)[(m_instructionPointer + 1) % 256], randomEngine);
+            = decodeAddress(species[(m_instructionPointer + 1) % 256], randomBuffer);
     } else {
         m_instructionPointer 
-            = decodeAddress((*m_species)[(m_instructionPointer + 2) % 256], randomEngine);
+            = decodeAddress(species[(m_instructionPointer + 2) % 256], randomBuffer);
     }
 }
 
-bool Bot::decodeCoords(uint16_t code, int& x, int& y, 
-                       const Field& field, mt19937_64& randomEngine) const noexcept {
-    int direction = decodeRotation((*m_species)[(m_instructionPointer + 3) % 256], randomEngine);
-    Vector2i coords = m_position + getOffsetForRotation(direction);
-    x = coords.x, y = coords.y;
+bool Bot::hasSameGenome(const Bot& other, const Field& field) const noexcept {
+    // different species can still have equal genomes
+    if (m_species == other.m_species) return true;
+    const SpeciesStore& store = field.getSpeciesStore();
+    return haveEqualGenomes(getSpeciesData(store), other.getSpeciesData(store));
+}
+
+bool Bot::sense(const DecisionCache::Test& test, const Field& field) const noexcept {
+    switch (static_cast<Instruction>(test.instruction)) {
+    case Instruction::TEST_ENERGY:
+        return m_energy > test.threshold;
+    case Instruction::TEST_GRASS:
+        return field.getGrass(m_position.x, m_position.y) > test.threshold % 256;
+    case Instruction::TEST_ORGANIC:
+        return field.getOrganic(m_position.x, m_position.y) > test.threshold % 256;
+    default:
+        break;
+    }
 
-    return field.getTopology().makeIndicesSafe(x, y);
+    Instruction instruction = static_cast<Instruction>(test.instruction);
+    // other directions are possible only after unusual turns of the topology
+    if (test.direction >= 0 && test.direction < 8) {
+        const Field::NeighbourMasks& masks = field.getNeighbourMasks(m_position.x, m_position.y);
+        uint8_t bit = static_cast<uint8_t>(1 << test.direction);
+        if (instruction == Instruction::TEST_EMPTY) return masks.empty & bit;
+        // only occupied cells are worth a look at the neighbour
+        if (!(masks.occupied & bit)) return false;
+    }
+
+    Vector2i coords = m_position + getOffsetForRotation(test.direction);
+    int x = coords.x, y = coords.y;
+    if (!field.getTopology().makeIndicesSafe(x, y)) return false;
+
+    const Cell& cell = field.at(x, y);
+    switch (instruction) {
+    case Instruction::TEST_EMPTY:
+        return !cell.hasBot();
+    case Instruction::TEST_ENEMY:
+        return cell.hasBot() && !hasSameGenome(cell.getBot(), field);
+    default:
+        return cell.hasBot() && hasSameGenome(cell.getBot(), field);
+    }
 }
 
-double Bot::useEnergy(double energy, const Field& field) noexcept {
-    double usedEnergy = std::min(energy, m_energy);
-    m_energy -= energy;
+double Bot::spendEnergy(double& energy, double amount, const Field& field) noexcept {
+    if (field.getSettings().fixedPointEnergy) {
+        // all used energy becomes organic, energy never gets negative
+        double usedEnergy = quantizeEnergy(std::clamp(amount, 0.0, energy));
+        energy -= usedEnergy;
+        return usedEnergy;
+    }
+
+    double usedEnergy = std::min(amount, energy);
+    energy -= amount;
     return usedEnergy * field.getSettings().usedEnergyOrganicRatio;
 }
 
+bool Bot::useInstructionsEnergy(int count, double energy, 
+                                Decision& decision, const Field& field) noexcept {
+    double wasEnergy = m_energy;
+    double organic = decision.organic;
+    for (int i = 0; i < count; ++ i) {
+        if (m_energy <= 0) {
+            m_energy = wasEnergy;
+            decision.organic = organic;
+            return false;
+        }
+        decision.organic += useEnergy(energy, field);
+    }
+    return true;
+}
+
+bool Bot::replaySegment(const DecisionCache::Segment& segment, double instructionCost,
+                        Decision& decision, const Field& field) noexcept {
+    double energy = m_energy;
+    double organic = decision.organic;
+    int used = 0;
+    for (int i = 0; i < segment.testCount; ++ i) {
+        const DecisionCache::Test& test = segment.tests[i];
+        if (!useInstructionsEnergy(test.offset - used, instructionCost, decision, field) 
+            || m_energy <= 0 || sense(test, field) != test.result) {
+            m_energy = energy;
+            decision.organic = organic;
+            return false;
+        }
+        used = test.offset;
+    }
+    if (!useInstructionsEnergy(segment.length - used, instructionCost, decision, field)) {
+        m_energy = energy;
+        decision.organic = organic;
+        return false;
+    }
+
+    m_instructionPointer = segment.target;
+    setRotation(segment.targetRotation);
+    return true;
+}
+
 const bool logToCout = false;
 
 Decision Bot::makeDecision(Field& field) noexcept {
+    DecisionState state;
+    if (!startDecision(state, field)) return state.decision;
+    return finishDecision(state, field);
+}
+
+bool Bot::startDecision(DecisionState& state, const Field& field) noexcept {
     if (++ m_age > field.getSettings().lifetime) {
         if (logToCout) std::cout << "Too old -> Action::DIE\n";
-        return {Decision::Action::DIE, -1, 0.0};
+        state.decision = {Decision::Action::DIE, -1, 0.0, DeathCause::AGE};
+        return false;
     }
 
-    Decision decision{Decision::Action::SKIP, -1, 0.0};
-
-    mt19937_64& randomEngine = field.getRandomEngine();
-    Cell& cell = field.at(m_position.x, m_position.y);
+    state.decision = {Decision::Action::SKIP, -1, 0.0};
+    state.wasEnergy = std::max(m_energy, 0.0) + state.decision.organic 
+                    + field.getGrass(m_position.x, m_position.y);
+    state.executed = 0;
+    state.cycleStart = -1;
+    state.cyclePower = 1;
+    state.cycleLength = 0;
+    state.cycleSteps = 0;
+    return true;
+}
 
-    double was_energy = std::max(m_energy, 0.0) + decision.organic + cell.getGrass();
+Decision Bot::finishDecision(const DecisionState& state, Field& field) noexcept {
+    Decision decision = state.decision;
+
+    RandomBuffer& randomBuffer = field.getRandomBuffer();
+    const Species& species = getSpeciesData(field.getSpeciesStore());
+    const ControlFlow& controlFlow = field.getSpeciesStore().getControlFlow(m_species);
+    double was_energy = state.wasEnergy;
+
+    int budget = field.getSettings().instructionBudget;
+    float instructionCost = field.getSettings().instructionCost;
+    int executed = state.executed;
+    // Brent's cycle detection over states reached by instructions without side effects,
+    // a repeated state means the bot never reaches an action until energy or budget ends
+    int cycleStart = state.cycleStart;
+    int cyclePower = state.cyclePower;
+    // instructions and steps since the cycle start, collapsed runs are single steps
+    int cycleLength = state.cycleLength;
+    int cycleSteps = state.cycleSteps;
+
+    // segment cached from the same start is replayed, otherwise a new one is recorded
+    DecisionCache* cache = field.getSettings().memoizeDecisions ? &field.getDecisionCache() : nullptr;
+    DecisionCache::Segment segment;
+    bool recording = false;
+    if (cache) {
+        const DecisionCache::Segment* cached 
+            = cache->find(m_species, m_instructionPointer, m_rotation);
+        if (cached && budget >= cached->length 
+            && replaySegment(*cached, instructionCost, decision, field)) {
+            cache->countHit();
+            executed = cached->length;
+        } else {
+            segment.species = m_species;
+            segment.instructionPointer = static_cast<uint8_t>(m_instructionPointer);
+            segment.rotation = static_cast<int8_t>(m_rotation);
+            recording = true;
+        }
+    }
+    auto finishSegment = [&] (int target, int rotation) {
+        recording = false;
+        if (segment.length == 0) return;
+        segment.target = static_cast<uint8_t>(target);
+        segment.targetRotation = static_cast<int8_t>(rotation);
+        cache->insert(segment);
+    };
 
     bool run = true;
     while (run && m_energy > 0) {
-        switch (static_cast<Bot::Instruction>(((*m_species)[m_instructionPointer]) % 16)) {
-        case Instruction::MOVE:
-            if (logToCout) std::cout << "Instruction::MOVE -> Action::MOVE\n";
-            decision.action = Decision::Action::MOVE;
-            decision.direction = decodeRotation((*m_species)[(m_instructionPointer + 1) % 256], 
-                                                field.getRandomEngine());
-            run = false;
-            m_instructionPointer += 2;
-            break;
-        case Instruction::ROTATE: {
-            int newRotation = m_rotation + 1;
-            setRotation(decodeRotation((*m_species)[(m_instructionPointer + 1) % 256], 
-                                       randomEngine));
-            m_instructionPointer += 2;
+        if (executed == budget) {
+            decision.capped = true;
             break;
         }
-        case Instruction::JMP:
-            m_instructionPointer 
-                = decodeAddress((*m_species)[(m_instructionPointer + 1) % 256], randomEngine);
-            break;
-        case Instruction::EAT: {
-            if (logToCout) std::cout << "Instruction::EAT -> Action::SKIP\n";
-            double eaten = min(field.getSettings().eatEfficiency * cell.getGrass(), 
-                               static_cast<double>(field.getSettings().energyGain));
-            cell.setGrass(cell.getGrass() - eaten / field.getSettings().eatEfficiency);
-            m_energy += eaten;
-            decision.organic += field.getSettings().eatenOrganicRatio 
-                                * (eaten / field.getSettings().eatEfficiency - eaten);
-
-            ++ m_eats;
-            if (field.getSettings().eatLong) {
-                decision.action = Decision::Action::SKIP;
+
+        int instructionStart = m_instructionPointer;
+        int rotationStart = m_rotation;
+        // random-free instruction without effects, tests included
+        bool fixed = false;
+        DecisionCache::Test test{};
+
+        // collapsed runs use energy per instruction, so they end exactly where stepping would,
+        // the opcode is checked first to not touch the control flow before actions
+        int runLength = isControlFlow(species[m_instructionPointer]) 
+                      ? controlFlow[m_instructionPointer].length : 0;
+        bool pure = false;
+        int length = 1;
+        if (runLength > 1 && budget - executed >= runLength 
+            && useInstructionsEnergy(runLength, instructionCost, decision, field)) {
+            const ControlFlow::Step& step = controlFlow[m_instructionPointer];
+            m_instructionPointer = step.target;
+            applyRotation(step);
+            pure = true;
+            fixed = true;
+            length = step.length;
+        } else {
+            switch (static_cast<Bot::Instruction>((species[m_instructionPointer]) % 16)) {
+            case Instruction::MOVE:
+                if (logToCout) std::cout << "Instruction::MOVE -> Action::MOVE\n";
+                decision.action = Decision::Action::MOVE;
+                decision.direction = decodeRotation(species[(m_instructionPointer + 1) % 256], 
+                                                    randomBuffer);
                 run = false;
+                m_instructionPointer += 2;
+                break;
+            case Instruction::ROTATE: {
+                pure = isFixedRotation(species[(m_instructionPointer + 1) % 256]);
+                fixed = pure;
+                setRotation(decodeRotation(species[(m_instructionPointer + 1) % 256], 
+                                           randomBuffer));
+                m_instructionPointer += 2;
+                break;
             }
-            ++ m_instructionPointer;
-            break;
-        }
-        case Instruction::SKIP:
-            if (logToCout) std::cout << "Instruction::SKIP -> Action::SKIP\n";
-            decision.action = Decision::Action::SKIP;
-            run = false;
-            ++ m_instructionPointer;
-            break;
-        case Instruction::DIE:
-            if (logToCout) std::cout << "Instruction::DIE -> Action::DIE\n";
-            decision.action = Decision::Action::DIE;
-            run = false;
-            ++ m_instructionPointer;
-            break;
-        case Instruction::MULTIPLY:
-            if (logToCout) std::cout << "Instruction::MULTIPLY";
-            if (m_energy > field.getSettings().multiplyCost) {
-                if (logToCout) std::cout << " -> Action::MULTIPLY";
-                decision.action = Decision::Action::MULTIPLY;
-                decision.direction = decodeRotation((*m_species)[(m_instructionPointer + 1) % 256], 
-                                                    randomEngine);
-                    
-                run = false;
-                m_energy -= field.getSettings().multiplyCost;
-                if (m_energy <= 0.0) {
-                    if (logToCout) std::cout << "ERROR: Shouldn't be able to MULTIPLY\n";
+            case Instruction::JMP:
+                pure = isFixedAddress(species[(m_instructionPointer + 1) % 256]);
+                fixed = pure;
+                m_instructionPointer 
+                    = decodeAddress(species[(m_instructionPointer + 1) % 256], randomBuffer);
+                break;
+            case Instruction::EAT: {
+                if (logToCout) std::cout << "Instruction::EAT -> Action::SKIP\n";
+                double grass = field.getGrass(m_position.x, m_position.y);
+                if (field.getSettings().fixedPointEnergy) {
+                    // grass that wasn't digested becomes organic
+                    double taken = quantizeEnergy(min(grass, 
+                        static_cast<double>(field.getSettings().energyGain) 
+                        / field.getSettings().eatEfficiency));
+                    double eaten = quantizeEnergy(min(field.getSettings().eatEfficiency, 1.f) * taken);
+                    field.setGrass(m_position.x, m_position.y, grass - taken);
+                    m_energy += eaten;
+                    decision.organic += taken - eaten;
+                } else {
+                    double eaten = min(field.getSettings().eatEfficiency * grass, 
+                                       static_cast<double>(field.getSettings().energyGain));
+                    field.setGrass(m_position.x, m_position.y, 
+                                   grass - eaten / field.getSettings().eatEfficiency);
+                    m_energy += eaten;
+                    decision.organic += field.getSettings().eatenOrganicRatio 
+                                        * (eaten / field.getSettings().eatEfficiency - eaten);
                 }
 
-                decision.organic += (field.getSettings().multiplyCost - field.getSettings().startEnergy) 
-                                * field.getSettings().usedEnergyOrganicRatio;
+                ++ m_eats;
+                if (field.getSettings().eatLong) {
+                    decision.action = Decision::Action::SKIP;
+                    run = false;
+                }
+                ++ m_instructionPointer;
+                break;
             }
-            if (logToCout) std::cout << '\n';
-            m_instructionPointer += 2;
-            break;
-        case Instruction::ATTACK:
-            if (logToCout) std::cout << "Instruction::ATTACK -> Action::ATTACK\n";
-            decision.action = Decision::Action::ATTACK;
-            decision.direction = decodeRotation((*m_species)[(m_instructionPointer + 1) % 256], 
-                                                randomEngine);
-            run = false;
-            m_instructionPointer += 2;
-            break;
-        case Instruction::TEST_EMPTY: {
-            int x, y;
-            if (decodeCoords((*m_species)[(m_instructionPointer + 3) % 256], 
-                             x, y, field, randomEngine)) {
-                executeTest(!field.at(x, y).hasBot(), randomEngine);
-            } else {
-                executeTest(false, randomEngine);
+            case Instruction::SKIP:
+                if (logToCout) std::cout << "Instruction::SKIP -> Action::SKIP\n";
+                decision.action = Decision::Action::SKIP;
+                run = false;
+                ++ m_instructionPointer;
+                break;
+            case Instruction::DIE:
+                if (logToCout) std::cout << "Instruction::DIE -> Action::DIE\n";
+                decision.action = Decision::Action::DIE;
+                decision.death = DeathCause::INSTRUCTION;
+                run = false;
+                ++ m_instructionPointer;
+                break;
+            case Instruction::MULTIPLY:
+                if (logToCout) std::cout << "Instruction::MULTIPLY";
+                // energy doesn't grow without EAT, so failed MULTIPLY fails again
+                pure = m_energy <= field.getSettings().multiplyCost;
+                if (m_energy > field.getSettings().multiplyCost) {
+                    if (logToCout) std::cout << " -> Action::MULTIPLY";
+                    decision.action = Decision::Action::MULTIPLY;
+                    decision.direction = decodeRotation(species[(m_instructionPointer + 1) % 256], 
+                                                        randomBuffer);
+                    
+                    run = false;
+                    if (field.getSettings().fixedPointEnergy) {
+                        double cost = quantizeEnergy(field.getSettings().multiplyCost);
+                        m_energy -= cost;
+                        decision.organic += cost - field.getOffspringEnergy();
+                    } else {
+                        m_energy -= field.getSettings().multiplyCost;
+                        decision.organic += (field.getSettings().multiplyCost 
+                                             - field.getSettings().startEnergy) 
+                                          * field.getSettings().usedEnergyOrganicRatio;
+                    }
+                    if (m_energy <= 0.0) {
+                        if (logToCout) std::cout << "ERROR: Shouldn't be able to MULTIPLY\n";
+                    }
+                }
+                if (logToCout) std::cout << '\n';
+                m_instructionPointer += 2;
+                break;
+            case Instruction::ATTACK:
+                if (logToCout) std::cout << "Instruction::ATTACK -> Action::ATTACK\n";
+                decision.action = Decision::Action::ATTACK;
+                decision.direction = decodeRotation(species[(m_instructionPointer + 1) % 256], 
+                                                    randomBuffer);
+                run = false;
+                m_instructionPointer += 2;
+                break;
+            case Instruction::TEST_EMPTY:
+            case Instruction::TEST_ENEMY:
+            case Instruction::TEST_ALLY: {
+                uint16_t code = species[(m_instructionPointer + 3) % 256];
+                fixed = hasFixedTest(species) && isFixedRotation(code);
+                pure = fixed;
+                test.instruction = static_cast<uint8_t>(species[m_instructionPointer] % 16);
+                test.direction = static_cast<int8_t>(decodeRotation(code, randomBuffer));
+                test.result = sense(test, field);
+                executeTest(test.result, species, randomBuffer);
+                break;
             }
-            break;
-        }
-        case Instruction::TEST_ENEMY: {
-            int x, y;
-            if (decodeCoords((*m_species)[(m_instructionPointer + 3) % 256], 
-                             x, y, field, randomEngine)) {
-                const Cell& cell = field.at(x, y);
-                executeTest(cell.hasBot() 
-                    && computeDifference(*m_species, *cell.getBot().getSpecies()) != 0, 
-                    randomEngine);
-            } else {
-                executeTest(false, randomEngine);
+            case Instruction::TEST_ENERGY:
+            case Instruction::TEST_GRASS:
+            case Instruction::TEST_ORGANIC:
+                fixed = hasFixedTest(species);
+                // energy changes with every instruction unless they are free
+                pure = fixed && (instructionCost == 0.f 
+                    || static_cast<Instruction>(species[m_instructionPointer] % 16) 
+                       != Instruction::TEST_ENERGY);
+                test.instruction = static_cast<uint8_t>(species[m_instructionPointer] % 16);
+                test.threshold = species[(m_instructionPointer + 3) % 256];
+                test.result = sense(test, field);
+                executeTest(test.result, species, randomBuffer);
+                break;
+            default: 
+                pure = true;
+                fixed = true;
+                ++ m_instructionPointer;
+                break;
             }
-            break;
+
+            if (logToCout) std::cout << "Energy: " << m_energy << '\n';
+            decision.organic += useEnergy(instructionCost, field);
         }
-        case Instruction::TEST_ALLY: {
-            int x, y;
-            if (decodeCoords((*m_species)[(m_instructionPointer + 3) % 256], 
-                             x, y, field, randomEngine)) {
-                const Cell& cell = field.at(x, y);
-                executeTest(field.at(x, y).hasBot()
-                    && computeDifference(*m_species, *cell.getBot().getSpecies()) == 0,
-                    randomEngine);
+        executed += length;
+
+        m_instructionPointer %= 256;
+        if (m_instructionPointer < 0) m_instructionPointer += 256;
+
+        if (recording) {
+            // segment ends before instructions with effects or random codes
+            if (!fixed || (test.instruction && segment.testCount == DecisionCache::MAX_TESTS) 
+                || segment.length + length > UINT16_MAX) {
+                finishSegment(instructionStart, rotationStart);
             } else {
-                executeTest(false, randomEngine);
+                if (test.instruction) {
+                    test.offset = segment.length;
+                    segment.tests[segment.testCount ++] = test;
+                }
+                segment.length += length;
             }
-            break;
-        }
-        case Instruction::TEST_ENERGY:
-            executeTest(m_energy > (*m_species)[(m_instructionPointer + 3) % 256], 
-                        randomEngine);
-            break;
-        case Instruction::TEST_GRASS:
-            executeTest(field.at(m_position.x, m_position.y).getGrass() > 
-                (*m_species)[(m_instructionPointer + 3) % 256] % 256, randomEngine);
-            break;
-        case Instruction::TEST_ORGANIC:
-            executeTest(field.at(m_position.x, m_position.y).getOrganic() > 
-                (*m_species)[(m_instructionPointer + 3) % 256] % 256, randomEngine);
-            break;
-        default: 
-            ++ m_instructionPointer;
-            break;
         }
 
-        if (logToCout) std::cout << "Energy: " << m_energy << '\n';
-        decision.organic += useEnergy(field.getSettings().instructionCost, field);
+        if (!pure) {
+            cycleStart = -1;
+            cyclePower = 1;
+            cycleLength = 0;
+            cycleSteps = 0;
+            continue;
+        }
 
-        m_instructionPointer %= 256;
-        if (m_instructionPointer < 0) m_instructionPointer += 256;
+        int state = m_instructionPointer << 8 | (m_rotation & 0xff);
+        cycleLength += length;
+        ++ cycleSteps;
+        if (state == cycleStart) {
+            if (recording) finishSegment(m_instructionPointer, m_rotation);
+            // whole turns of the cycle only use energy, the rest is interpreted as usual
+            if (instructionCost == 0.f) {
+                executed += (budget - executed) / cycleLength * cycleLength;
+            } else {
+                while (budget - executed >= cycleLength 
+                       && useInstructionsEnergy(cycleLength, instructionCost, decision, field))
+                    executed += cycleLength;
+            }
+            cycleStart = -1;
+            cyclePower = 1;
+            cycleLength = 0;
+            cycleSteps = 0;
+        } else if (cycleSteps == cyclePower) {
+            cycleStart = state;
+            cyclePower *= 2;
+            cycleLength = 0;
+            cycleSteps = 0;
+        }
     }
 
     if (logToCout) std::cout << "Energy (at update end): " << m_energy << '\n';
     decision.organic += useEnergy(1.0, field);
     if (m_energy <= 0) {
-        if (decision.action == Decision::Action::MULTIPLY) 
-            decision.organic += field.getSettings().startEnergy * field.getSettings().diedOrganicRatio;
-            // energy for offspring creation should be dropped
+        // energy for offspring creation should be dropped
+        if (decision.action == Decision::Action::MULTIPLY) {
+            if (field.getSettings().fixedPointEnergy)
+                decision.organic += field.getOffspringEnergy();
+            else
+                decision.organic += field.getSettings().startEnergy 
+                                  * field.getSettings().diedOrganicRatio;
+        }
         
         decision.action = Decision::Action::DIE;
+        decision.death = DeathCause::STARVATION;
         
         if (logToCout) std::cout << "Not enough energy -> Action::DIE\n";
     }
 
-    double delta_energy = (std::max(m_energy, 0.0) + decision.organic + cell.getGrass()) - was_energy;
+    double delta_energy = (std::max(m_energy, 0.0) + decision.organic 
+                           + field.getGrass(m_position.x, m_position.y)) - was_energy;
     if (decision.action == Decision::Action::MULTIPLY) {
         delta_energy += field.getSettings().startEnergy;
     }
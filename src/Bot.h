@@ -15,7 +15,11 @@ If not, see <https://www.gnu.org/licenses/>. */
 #define BOT_H_
 
 #include "Species.h"
+#include "SpeciesStore.h"
+#include "ControlFlow.h"
+#include "DecisionCache.h"
 #include "Decision.h"
+#include "RandomBuffer.h"
 #include "utility.h"
 
 #include <SFML/Graphics.hpp>
@@ -27,6 +31,20 @@ class Field;
 
 class Bot {
 public:
+    // interpreter state between two instructions of a decision
+    struct DecisionState {
+        Decision decision;
+        // energy of the bot and its cell at the start, for the energy balance check
+        double wasEnergy;
+        int executed;
+        // Brent's cycle detection
+        int cycleStart;
+        int cyclePower;
+        int cycleLength;
+        int cycleSteps;
+    };
+
+
     enum class Instruction {
         MOVE = 1,
         ROTATE,
@@ -45,15 +63,20 @@ public:
     };
 
     Bot() noexcept;
-    Bot(sf::Vector2i position, int rotation, double energy, std::shared_ptr<Species> species) noexcept;
+    Bot(sf::Vector2i position, int rotation, double energy, SpeciesHandle species) noexcept;
+
+    // bots come from a Pool, so moves and births in a steady population don't allocate
+    static void* operator new(std::size_t size);
+    static void operator delete(void* pointer) noexcept;
 
-    static Bot createRandom(sf::Vector2i position, std::mt19937_64& randomEngine) noexcept {
-        int rotation = std::uniform_int_distribution(0, 7)(randomEngine);
-        return Bot{position, rotation, 10.0, Species::createRandom(randomEngine)};
+    // species is created in the store of the field the bot is for
+    static Bot createRandom(sf::Vector2i position, SpeciesStore& store, RandomBuffer& randomBuffer) {
+        int rotation = static_cast<int>(randomBuffer.getBelow(8));
+        return Bot{position, rotation, 10.0, store.createRandom(randomBuffer)};
     }
 
-    sf::Color getColor() const noexcept {
-        return m_species->getColor();
+    sf::Color getColor(const SpeciesStore& store) const noexcept {
+        return getSpeciesData(store).getColor();
     }
 
     int getRotation() const noexcept {
@@ -62,15 +85,28 @@ public:
 
     void setRotation(int rotation) noexcept {
         m_rotation = rotation;
-        m_directionShape.setRotation(-m_rotation * 45.f);
     }
 
-    std::shared_ptr<Species> getSpecies() const noexcept {
+    SpeciesHandle getSpecies() const noexcept {
         return m_species;
     }
 
+    void setSpecies(SpeciesHandle species) noexcept {
+        m_species = species;
+    }
+
+    // stable through moves, 0 for bots that aren't in a field
+    uint64_t getId() const noexcept {
+        return m_id;
+    }
+
+    void setId(uint64_t id) noexcept {
+        m_id = id;
+    }
+
+    // a moved bot senses and acts from its new cell
     void setPosition(sf::Vector2i position) noexcept {
-        m_directionShape.setPosition(position.x + 0.5f, position.y + 0.5f);
+        m_position = position;
     }
 
     double getEnergy() const noexcept {
@@ -99,25 +135,47 @@ public:
     }
 
     Decision makeDecision(Field& field) noexcept;
+    // makeDecision in two parts, so LockstepInterpreter can advance decisions in between,
+    // returns false if the bot dies of age, state.decision is final then
+    bool startDecision(DecisionState& state, const Field& field) noexcept;
+    Decision finishDecision(const DecisionState& state, Field& field) noexcept;
+
+    // uses energy from a bot's energy, returns the part that becomes organic
+    static double spendEnergy(double& energy, double amount, const Field& field) noexcept;
 
-    void drawDirection(sf::RenderTarget& target, sf::RenderStates states) const noexcept {
-        target.draw(m_directionShape, states);
+    // codes decoded without the random engine
+    static bool isFixedRotation(uint16_t code) noexcept {
+        return code & (1 << 4 | 1 << 3);
     }
 
-    inline friend std::ostream& operator<< (std::ostream& os, const Bot& bot) noexcept {
-        os << bot.m_instructionPointer << ' ' << bot.m_age << ' ' << *bot.m_species;
-        return os;
+    static bool isFixedAddress(uint16_t code) noexcept {
+        return code & (1 << 9 | 1 << 8);
     }
 
-    inline friend std::istream& operator>> (std::istream& is, Bot& bot) noexcept {  
-        auto species = std::make_shared<Species>();
-        is >> bot.m_instructionPointer >> bot.m_age >> *species;
-        bot.setSpecies(species);
-        return is;
+    // only ROTATE, JMP and codes without instruction are collapsed by ControlFlow
+    static bool isControlFlow(uint16_t code) noexcept {
+        int instruction = code % 16;
+        return instruction == static_cast<int>(Instruction::ROTATE) 
+            || instruction == static_cast<int>(Instruction::JMP) 
+            || instruction == 0 || instruction > static_cast<int>(Instruction::TEST_ORGANIC);
+    }
+
+    // the genome is written in full, so the bot can be read into another field
+    void write(std::ostream& os, const SpeciesStore& store) const {
+        os << m_instructionPointer << ' ' << m_age << ' ' << getSpeciesData(store);
+    }
+
+    void read(std::istream& is, SpeciesStore& store) {
+        Species species;
+        is >> m_instructionPointer >> m_age >> species;
+        setSpecies(store.create(species));
     }
 private:
+    friend class LockstepInterpreter;
+
+    uint64_t m_id;
     int m_instructionPointer;
-    std::shared_ptr<Species> m_species;
+    SpeciesHandle m_species;
     int m_age;
     double m_energy;
 
@@ -127,20 +185,44 @@ private:
     sf::Vector2i m_position;
     int m_rotation;
 
-    sf::RectangleShape m_directionShape;
+    const Species& getSpeciesData(const SpeciesStore& store) const noexcept {
+        return store[m_species];
+    }
 
-    void setSpecies(std::shared_ptr<Species> species) noexcept {
-        m_species = species;
+    bool hasFixedTest(const Species& species) const noexcept {
+        return isFixedAddress(species[(m_instructionPointer + 1) % 256]) 
+            && isFixedAddress(species[(m_instructionPointer + 2) % 256]);
     }
 
-    int decodeRotation(uint16_t code, std::mt19937_64& randomEngine) const noexcept;
-    int decodeAddress(uint16_t code, std::mt19937_64& randomEngine) const noexcept;
-    bool decodeCoords(uint16_t code, int& x, int& y, 
-                      const Field& field, std::mt19937_64& randomEngine) const noexcept;
+    int decodeRotation(uint16_t code, RandomBuffer& randomBuffer) const noexcept;
+    int decodeAddress(uint16_t code, RandomBuffer& randomBuffer) const noexcept;
+    // condition of a TEST instruction, test.direction is used only by neighbour tests
+    bool sense(const DecisionCache::Test& test, const Field& field) const noexcept;
 
-    void executeTest(bool condition, std::mt19937_64& randomEngine) noexcept;
+    void executeTest(bool condition, const Species& species, RandomBuffer& randomBuffer) noexcept;
 
-    double useEnergy(double energy, const Field& field) noexcept;
+    bool hasSameGenome(const Bot& other, const Field& field) const noexcept;
+
+    double useEnergy(double energy, const Field& field) noexcept {
+        return spendEnergy(m_energy, energy, field);
+    }
+
+    // uses energy of instructions one by one, 
+    // returns false and restores energy if it ends before the last of them
+    bool useInstructionsEnergy(int count, double energy, 
+                               Decision& decision, const Field& field) noexcept;
+
+    // checks tests of the segment at the energy they were made with, 
+    // returns false and restores energy if any of them changed
+    bool replaySegment(const DecisionCache::Segment& segment, double instructionCost,
+                       Decision& decision, const Field& field) noexcept;
+
+    void applyRotation(const ControlFlow::Step& step) noexcept {
+        if (step.rotation == ControlFlow::Rotation::TURN) 
+            setRotation((getRotation() + step.rotationValue) % 8);
+        else if (step.rotation == ControlFlow::Rotation::SET) 
+            setRotation(step.rotationValue);
+    }
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,56 @@
+/* This file is part of JCyberEvolution.
+
+JCyberEvolution is free software: you can redistribute it and/or modify it 
+under the terms of the GNU General Public License as published by the Free Software Foundation, 
+either version 3 of the License, or (at your option) any later version.
+
+JCyberEvolution is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with JCyberEvolution. 
+If not, see <https://www.gnu.org/licenses/>. */
+
+#ifndef BOT_EVENT_H_
+#define BOT_EVENT_H_
+
+#include "SpeciesStore.h"
+#include "Decision.h"
+
+#include <SFML/System.hpp>
+
+#include <span>
+#include <cstdint>
+
+struct BotEvent {
+    enum class Type : uint8_t {
+        BORN = 0,
+        MOVED,
+        DIED,
+        KILLED
+    };
+
+    Type type;
+    // NONE for born and moved bots
+    DeathCause death;
+    sf::Vector2i position;
+    // parent of born bots, previous position of moved ones, killer of killed ones,
+    // equal to position if there is none
+    sf::Vector2i source;
+    SpeciesHandle species;
+    uint64_t botId;
+    // 0 for bots placed from outside of the simulation
+    uint64_t parentId;
+    // energy of the bot when the event happened
+    float energy;
+};
+
+// events of an epoch are delivered after it in the order they happened
+class BotEventObserver {
+public:
+    virtual ~BotEventObserver() = default;
+
+    virtual void handleBotEvents(std::span<const BotEvent> events, int epoch) = 0;
+};
+
+#endif
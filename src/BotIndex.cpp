@@ -0,0 +1,100 @@
+/* This file is part of JCyberEvolution.
+
+JCyberEvolution is free software: you can redistribute it and/or modify it 
+under the terms of the GNU General Public License as published by the Free Software Foundation, 
+either version 3 of the License, or (at your option) any later version.
+
+JCyberEvolution is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with JCyberEvolution. 
+If not, see <https://www.gnu.org/licenses/>. */
+
+#include "BotIndex.h"
+#include "utility.h"
+
+#include <vector>
+using std::vector;
+using std::ssize;
+
+#include <algorithm>
+using std::max;
+using std::fill;
+
+#include <utility>
+using std::swap;
+
+#include <cassert>
+
+BotIndex::BotIndex() noexcept : m_entries{}, m_size{0} {}
+
+int BotIndex::getHome(uint64_t id) const noexcept {
+    return static_cast<int>(splitMix64(id) & (m_entries.size() - 1));
+}
+
+void BotIndex::set(uint64_t id, int cell) {
+    assert(id != NO_ID);
+    // load factor is kept at most 1/2, so probe sequences stay short
+    if (2 * (m_size + 1) > ssize(m_entries)) grow();
+
+    int mask = ssize(m_entries) - 1;
+    for (int position = getHome(id); ; position = (position + 1) & mask) {
+        Entry& entry = m_entries[position];
+        if (entry.id == id) {
+            entry.cell = cell;
+            return;
+        }
+        if (entry.id == NO_ID) {
+            entry = {id, cell};
+            ++ m_size;
+            return;
+        }
+    }
+}
+
+void BotIndex::erase(uint64_t id) noexcept {
+    if (m_entries.empty()) return;
+
+    int mask = ssize(m_entries) - 1;
+    int position = getHome(id);
+    while (m_entries[position].id != id) {
+        if (m_entries[position].id == NO_ID) return;
+        position = (position + 1) & mask;
+    }
+
+    // entries after the hole move into it unless it's before their home
+    for (int next = (position + 1) & mask; m_entries[next].id != NO_ID; next = (next + 1) & mask) {
+        int home = getHome(m_entries[next].id);
+        if (((next - home) & mask) >= ((next - position) & mask)) {
+            m_entries[position] = m_entries[next];
+            position = next;
+        }
+    }
+    m_entries[position] = Entry{};
+    -- m_size;
+}
+
+int BotIndex::find(uint64_t id) const noexcept {
+    if (m_entries.empty() || id == NO_ID) return NONE;
+
+    int mask = ssize(m_entries) - 1;
+    for (int position = getHome(id); ; position = (position + 1) & mask) {
+        const Entry& entry = m_entries[position];
+        if (entry.id == id) return entry.cell;
+        if (entry.id == NO_ID) return NONE;
+    }
+}
+
+void BotIndex::clear() noexcept {
+    fill(m_entries.begin(), m_entries.end(), Entry{});
+    m_size = 0;
+}
+
+void BotIndex::grow() {
+    vector<Entry> entries(max(2 * m_entries.size(), static_cast<size_t>(MIN_CAPACITY)));
+    swap(entries, m_entries);
+    m_size = 0;
+    for (const Entry& entry : entries)
+        if (entry.id != NO_ID) set(entry.id, entry.cell);
+}
@@ -0,0 +1,56 @@
+/* This file is part of JCyberEvolution.
+
+JCyberEvolution is free software: you can redistribute it and/or modify it 
+under the terms of the GNU General Public License as published by the Free Software Foundation, 
+either version 3 of the License, or (at your option) any later version.
+
+JCyberEvolution is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with JCyberEvolution. 
+If not, see <https://www.gnu.org/licenses/>. */
+
+#ifndef BOT_INDEX_H_
+#define BOT_INDEX_H_
+
+#include <vector>
+#include <cstdint>
+
+// open addressing hash table from bot ids to cells, linear probing, 
+// erasing shifts the rest of the cluster back, so there are no tombstones
+class BotIndex {
+public:
+    static constexpr uint64_t NO_ID = 0;
+    static constexpr int NONE = -1;
+
+    BotIndex() noexcept;
+
+    // inserts or moves the bot
+    void set(uint64_t id, int cell);
+    void erase(uint64_t id) noexcept;
+
+    // NONE if there is no such bot
+    int find(uint64_t id) const noexcept;
+
+    void clear() noexcept;
+
+    int getSize() const noexcept {
+        return m_size;
+    }
+private:
+    struct Entry {
+        uint64_t id = NO_ID;
+        int cell = NONE;
+    };
+
+    static constexpr int MIN_CAPACITY = 1024;
+
+    std::vector<Entry> m_entries;
+    int m_size;
+
+    int getHome(uint64_t id) const noexcept;
+    void grow();
+};
+
+#endif
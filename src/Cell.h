@@ -71,22 +71,6 @@ public:
         return false;
     }
 
-    double getGrass() const noexcept {
-        return m_grass;
-    }
-
-    void setGrass(double grass) noexcept {
-        m_grass = grass;
-    }
-
-    double getOrganic() const noexcept {
-        return m_organic;
-    }
-
-    void setOrganic(double organic) noexcept {
-        m_organic = organic;
-    }
-
     bool isAlive() const noexcept {
         return hasBot() && !m_shouldDie;
     }
@@ -94,9 +78,6 @@ private:
     std::unique_ptr<Bot> m_bot;
     bool m_shouldDie;
 
-    double m_grass;
-    double m_organic;
-
     sf::Vector2i m_position;
 };
 
@@ -0,0 +1,166 @@
+/* This file is part of JCyberEvolution.
+
+JCyberEvolution is free software: you can redistribute it and/or modify it 
+under the terms of the GNU General Public License as published by the Free Software Foundation, 
+either version 3 of the License, or (at your option) any later version.
+
+JCyberEvolution is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with JCyberEvolution. 
+If not, see <https://www.gnu.org/licenses/>. */
+
+#include "ControlFlow.h"
+#include "Species.h"
+#include "Bot.h"
+
+#include <array>
+using std::array;
+
+#include <cstdint>
+
+using Instruction = Bot::Instruction;
+
+// see Bot::decodeAddress
+static int decodeFixedAddress(uint16_t code, int instructionPointer) noexcept {
+    if (code & (1 << 9)) return (instructionPointer + code % 256) % 256;
+    return code % 256;
+}
+
+// single instruction as a step, of length 0 if it can't be collapsed,
+// decoded without branches on the opcode, which are unpredictable in random genomes
+static ControlFlow::Step getStep(const Species& species, int instructionPointer) noexcept {
+    int instruction = species[instructionPointer] % 16;
+    uint16_t code = species[(instructionPointer + 1) % 256];
+    bool rotate = instruction == static_cast<int>(Instruction::ROTATE) && Bot::isFixedRotation(code);
+    bool jump = instruction == static_cast<int>(Instruction::JMP) && Bot::isFixedAddress(code);
+    // codes without instruction only move the pointer
+    bool skip = instruction == 0 || instruction > static_cast<int>(Instruction::TEST_ORGANIC);
+
+    ControlFlow::Step step;
+    step.length = rotate || jump || skip;
+    step.target = static_cast<uint8_t>(jump ? decodeFixedAddress(code, instructionPointer) 
+                                            : (instructionPointer + (rotate ? 2 : 1)) % 256);
+    if (rotate) {
+        step.rotation = code & (1 << 4) ? ControlFlow::Rotation::TURN : ControlFlow::Rotation::SET;
+        step.rotationValue = static_cast<uint8_t>(code % 8);
+    }
+    return step;
+}
+
+// rotation of the step followed by rotation of the next one
+static void appendRotation(ControlFlow::Step& step, const ControlFlow::Step& next) noexcept {
+    using Rotation = ControlFlow::Rotation;
+    if (next.rotation == Rotation::KEEP) return;
+    if (next.rotation == Rotation::SET || step.rotation == Rotation::KEEP) {
+        step.rotation = next.rotation;
+        step.rotationValue = next.rotationValue;
+    } else if (step.rotation == Rotation::SET) {
+        step.rotationValue = (step.rotationValue + next.rotationValue) % 8;
+    } else {
+        // rotation above -8 turned by 8 or more is non-negative, only the residue matters then
+        int value = step.rotationValue + next.rotationValue;
+        step.rotationValue = static_cast<uint8_t>(value < 8 ? value : 8 + value % 8);
+    }
+}
+
+ControlFlow::ControlFlow() noexcept : m_steps{}, m_reachable{} {}
+
+ControlFlow::ControlFlow(const Species& species) noexcept : m_steps{}, m_reachable{} {
+    collapseRuns(species);
+    findReachable(species);
+}
+
+void ControlFlow::collapseRuns(const Species& species) noexcept {
+    enum State : uint8_t {
+        NEW = 0,
+        ON_PATH,
+        DONE,
+        CYCLIC,
+    };
+
+    array<State, 256> states;
+    states.fill(NEW);
+    array<uint8_t, 256> path;
+    for (int start = 0; start < 256; ++ start) {
+        int size = 0;
+        int instructionPointer = start;
+        while (states[instructionPointer] == NEW) {
+            Step step = getStep(species, instructionPointer);
+            if (step.length == 0) break;
+            states[instructionPointer] = ON_PATH;
+            path[size ++] = static_cast<uint8_t>(instructionPointer);
+            instructionPointer = step.target;
+        }
+
+        // runs into a cycle never end, they are left to the loop detection of the interpreter
+        if (states[instructionPointer] == ON_PATH || states[instructionPointer] == CYCLIC) {
+            for (int i = 0; i < size; ++ i) states[path[i]] = CYCLIC;
+            continue;
+        }
+
+        // nodes of the path are distinct and a cycle can't be reached, so runs are below 256
+        Step next;
+        next.target = static_cast<uint8_t>(instructionPointer);
+        if (states[instructionPointer] == DONE) next = m_steps[instructionPointer];
+        for (int i = size - 1; i >= 0; -- i) {
+            Step step = getStep(species, path[i]);
+            step.target = next.target;
+            step.length = static_cast<uint8_t>(next.length + 1);
+            appendRotation(step, next);
+            m_steps[path[i]] = step;
+            states[path[i]] = DONE;
+            next = step;
+        }
+    }
+}
+
+void ControlFlow::findReachable(const Species& species) noexcept {
+    m_reachable.reset();
+    array<uint8_t, 256> stack;
+    int size = 0;
+    auto visit = [&] (int instructionPointer) {
+        if (m_reachable[instructionPointer]) return;
+        m_reachable[instructionPointer] = true;
+        stack[size ++] = static_cast<uint8_t>(instructionPointer);
+    };
+    // random address can be any
+    auto visitAddress = [&] (int instructionPointer, int offset) {
+        uint16_t code = species[(instructionPointer + offset) % 256];
+        if (Bot::isFixedAddress(code)) {
+            visit(decodeFixedAddress(code, instructionPointer));
+        } else {
+            m_reachable.set();
+            size = 0;
+        }
+    };
+
+    visit(0);
+    while (size > 0) {
+        int instructionPointer = stack[-- size];
+        switch (static_cast<Instruction>(species[instructionPointer] % 16)) {
+        case Instruction::MOVE:
+        case Instruction::ROTATE:
+        case Instruction::MULTIPLY:
+        case Instruction::ATTACK:
+            visit((instructionPointer + 2) % 256);
+            break;
+        case Instruction::JMP:
+            visitAddress(instructionPointer, 1);
+            break;
+        case Instruction::TEST_EMPTY:
+        case Instruction::TEST_ENEMY:
+        case Instruction::TEST_ALLY:
+        case Instruction::TEST_ENERGY:
+        case Instruction::TEST_GRASS:
+        case Instruction::TEST_ORGANIC:
+            visitAddress(instructionPointer, 1);
+            visitAddress(instructionPointer, 2);
+            break;
+        default:
+            visit((instructionPointer + 1) % 256);
+            break;
+        }
+    }
+}
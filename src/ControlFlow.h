@@ -0,0 +1,67 @@
+/* This file is part of JCyberEvolution.
+
+JCyberEvolution is free software: you can redistribute it and/or modify it 
+under the terms of the GNU General Public License as published by the Free Software Foundation, 
+either version 3 of the License, or (at your option) any later version.
+
+JCyberEvolution is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with JCyberEvolution. 
+If not, see <https://www.gnu.org/licenses/>. */
+
+#ifndef CONTROL_FLOW_H_
+#define CONTROL_FLOW_H_
+
+#include <array>
+#include <bitset>
+#include <cstdint>
+
+class Species;
+
+// control flow graph of a genome built once per species,
+// runs of no-op instructions and of ROTATE and JMP with fixed codes are collapsed into single steps
+class ControlFlow {
+public:
+    enum class Rotation : uint8_t {
+        KEEP = 0,
+        // (rotation + value) % 8, like a relative ROTATE
+        TURN,
+        SET,
+    };
+
+    struct Step {
+        // instruction pointer after the run
+        uint8_t target = 0;
+        // instructions in the run, 0 if the instruction isn't collapsed
+        uint8_t length = 0;
+        Rotation rotation = Rotation::KEEP;
+        // turns are kept below 16, so rotations in (-8, 8) change as instruction by instruction
+        uint8_t rotationValue = 0;
+    };
+
+    ControlFlow() noexcept;
+    explicit ControlFlow(const Species& species) noexcept;
+
+    const Step& operator[] (int instructionPointer) const noexcept {
+        return m_steps[instructionPointer];
+    }
+
+    // reachable from the first instruction, where bots are born
+    bool isReachable(int instructionPointer) const noexcept {
+        return m_reachable[instructionPointer];
+    }
+
+    int getReachableCount() const noexcept {
+        return static_cast<int>(m_reachable.count());
+    }
+private:
+    std::array<Step, 256> m_steps;
+    std::bitset<256> m_reachable;
+
+    void collapseRuns(const Species& species) noexcept;
+    void findReachable(const Species& species) noexcept;
+};
+
+#endif
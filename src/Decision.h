@@ -15,6 +15,18 @@ If not, see <https://www.gnu.org/licenses/>. */
 #ifndef DECISION_H_
 #define DECISION_H_
 
+#include <cstdint>
+
+enum class DeathCause : uint8_t {
+    NONE = 0,
+    AGE,
+    STARVATION,
+    INSTRUCTION,
+    KILLED,
+    // deleted or replaced from outside of the simulation
+    REMOVED
+};
+
 struct Decision {
     enum class Action {
         SKIP = 0,
@@ -27,6 +39,10 @@ struct Decision {
     Action action;
     int direction;
     double organic;
+    // why the bot decided to DIE
+    DeathCause death = DeathCause::NONE;
+    // the bot ran out of its instruction budget before choosing an action
+    bool capped = false;
 };
 
 #endif
\ No newline at end of file
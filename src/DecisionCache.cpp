@@ -0,0 +1,61 @@
+/* This file is part of JCyberEvolution.
+
+JCyberEvolution is free software: you can redistribute it and/or modify it 
+under the terms of the GNU General Public License as published by the Free Software Foundation, 
+either version 3 of the License, or (at your option) any later version.
+
+JCyberEvolution is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with JCyberEvolution. 
+If not, see <https://www.gnu.org/licenses/>. */
+
+#include "DecisionCache.h"
+#include "SpeciesStore.h"
+#include "utility.h"
+
+#include <vector>
+using std::vector;
+
+#include <cstdint>
+
+DecisionCache::DecisionCache() noexcept : m_segments{}, m_lookups{0}, m_hits{0} {}
+
+int DecisionCache::getPosition(SpeciesHandle species, 
+                               int instructionPointer, int rotation) noexcept {
+    uint64_t key = static_cast<uint64_t>(species.getValue()) << 16 
+                 | static_cast<uint64_t>(instructionPointer) << 8 | (rotation & 0xff);
+    return static_cast<int>(splitMix64(key) >> (64 - SIZE_BITS));
+}
+
+const DecisionCache::Segment* DecisionCache::find(SpeciesHandle species, 
+                                                  int instructionPointer, int rotation) noexcept {
+    ++ m_lookups;
+    if (m_segments.empty()) return nullptr;
+
+    const Segment& segment = m_segments[getPosition(species, instructionPointer, rotation)];
+    if (segment.length == 0 || segment.species != species 
+        || segment.instructionPointer != instructionPointer || segment.rotation != rotation) 
+            return nullptr;
+    return &segment;
+}
+
+void DecisionCache::allocate() {
+    if (m_segments.empty()) m_segments.resize(1 << SIZE_BITS);
+}
+
+void DecisionCache::insert(const Segment& segment) noexcept {
+    m_segments[getPosition(segment.species, segment.instructionPointer, segment.rotation)] = segment;
+}
+
+void DecisionCache::removeExtinct(const SpeciesStore& store) noexcept {
+    for (Segment& segment : m_segments)
+        if (segment.length > 0 && !store.isAlive(segment.species)) segment.length = 0;
+}
+
+void DecisionCache::clear() noexcept {
+    for (Segment& segment : m_segments)
+        segment.length = 0;
+    resetCounters();
+}
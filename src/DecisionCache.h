@@ -0,0 +1,90 @@
+/* This file is part of JCyberEvolution.
+
+JCyberEvolution is free software: you can redistribute it and/or modify it 
+under the terms of the GNU General Public License as published by the Free Software Foundation, 
+either version 3 of the License, or (at your option) any later version.
+
+JCyberEvolution is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with JCyberEvolution. 
+If not, see <https://www.gnu.org/licenses/>. */
+
+#ifndef DECISION_CACHE_H_
+#define DECISION_CACHE_H_
+
+#include "SpeciesStore.h"
+
+#include <array>
+#include <vector>
+#include <cstdint>
+
+// random-free segments of control flow and tests at the start of decisions,
+// keyed by species, instruction pointer and rotation, and replayed by checking their tests again,
+// direct mapped, a new segment replaces the old one
+class DecisionCache {
+public:
+    static constexpr int MAX_TESTS = 8;
+
+    struct Test {
+        // instructions of the segment before the test
+        uint16_t offset;
+        uint16_t threshold;
+        // decoded direction of neighbour tests
+        int8_t direction;
+        uint8_t instruction;
+        bool result;
+    };
+
+    struct Segment {
+        SpeciesHandle species;
+        uint8_t instructionPointer = 0;
+        int8_t rotation = 0;
+        // instructions in the segment, 0 for empty entries
+        uint16_t length = 0;
+        uint8_t target = 0;
+        int8_t targetRotation = 0;
+        uint8_t testCount = 0;
+        std::array<Test, MAX_TESTS> tests;
+    };
+
+    DecisionCache() noexcept;
+
+    // nullptr if there is no segment from the state
+    const Segment* find(SpeciesHandle species, int instructionPointer, int rotation) noexcept;
+
+    // the table is allocated only when memoization is enabled
+    void allocate();
+
+    // unsafe, the table should be allocated
+    void insert(const Segment& segment) noexcept;
+
+    void countHit() noexcept {
+        ++ m_hits;
+    }
+
+    // share of lookups since the last reset that were replayed
+    float getHitRate() const noexcept {
+        return m_lookups > 0 ? static_cast<float>(m_hits) / m_lookups : 0.f;
+    }
+
+    void resetCounters() noexcept {
+        m_lookups = 0;
+        m_hits = 0;
+    }
+
+    // segments of collected species are dropped, so reused handles can't match them
+    void removeExtinct(const SpeciesStore& store) noexcept;
+    void clear() noexcept;
+private:
+    static constexpr int SIZE_BITS = 15;
+
+    std::vector<Segment> m_segments;
+    int m_lookups;
+    int m_hits;
+
+    static int getPosition(SpeciesHandle species, int instructionPointer, int rotation) noexcept;
+};
+
+#endif
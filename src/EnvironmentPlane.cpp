@@ -0,0 +1,63 @@
+/* This file is part of JCyberEvolution.
+
+JCyberEvolution is free software: you can redistribute it and/or modify it 
+under the terms of the GNU General Public License as published by the Free Software Foundation, 
+either version 3 of the License, or (at your option) any later version.
+
+JCyberEvolution is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with JCyberEvolution. 
+If not, see <https://www.gnu.org/licenses/>. */
+
+#include "EnvironmentPlane.h"
+
+#include <algorithm>
+using std::fill;
+using std::min;
+using std::max;
+
+#include <cmath>
+using std::floor;
+using std::frexp;
+using std::ldexp;
+
+EnvironmentPlane::EnvironmentPlane(Format format, int size) noexcept : 
+        m_format{format}, m_doubles{}, m_values{} {
+    if (format == Format::DOUBLE)
+        m_doubles.assign(size, 0.0);
+    else
+        m_values.assign(size, 0);
+}
+
+void EnvironmentPlane::fill(double value) noexcept {
+    if (m_format == Format::DOUBLE) {
+        std::fill(m_doubles.begin(), m_doubles.end(), value);
+        return;
+    }
+
+    uint16_t encoded = m_format == Format::FIXED_16 ? encodeFixed16(value, NEAREST_NOISE) 
+                                                    : encodeHalf(value, NEAREST_NOISE);
+    std::fill(m_values.begin(), m_values.end(), encoded);
+}
+
+uint16_t EnvironmentPlane::encodeFixed16(double value, uint32_t noise) noexcept {
+    double scaled = floor(value * 256 + noise * 0x1p-32);
+    return static_cast<uint16_t>(min(max(scaled, 0.0), 65535.0));
+}
+
+uint16_t EnvironmentPlane::encodeHalf(double value, uint32_t noise) noexcept {
+    if (!(value > 0.0)) return 0;
+
+    // value = 0.5..1 * 2^exponent, binary16 stores it as 1024..2047 * 2^(biased - 25),
+    // subnormals share the scale of the smallest normal exponent
+    int exponent;
+    frexp(value, &exponent);
+    int biased = max(exponent + 14, 1);
+    double scaled = floor(ldexp(value, 25 - biased) + noise * 0x1p-32);
+
+    // rounding up to 2048 carries into the exponent by itself
+    double half = (biased - 1) * 1024.0 + scaled;
+    return static_cast<uint16_t>(min(half, 0x7BFF * 1.0));
+}
@@ -0,0 +1,97 @@
+/* This file is part of JCyberEvolution.
+
+JCyberEvolution is free software: you can redistribute it and/or modify it 
+under the terms of the GNU General Public License as published by the Free Software Foundation, 
+either version 3 of the License, or (at your option) any later version.
+
+JCyberEvolution is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with JCyberEvolution. 
+If not, see <https://www.gnu.org/licenses/>. */
+
+#ifndef ENVIRONMENT_PLANE_H_
+#define ENVIRONMENT_PLANE_H_
+
+#include <vector>
+#include <cstdint>
+#include <bit>
+
+// one environment value (grass or organic) for every cell of a chunk
+class EnvironmentPlane {
+public:
+    enum class Format {
+        DOUBLE = 0,
+        FIXED_16, // unsigned 8.8 fixed point, up to 255.996
+        HALF      // IEEE 754 binary16, non-negative values only
+    };
+
+    // noise is added to the value scaled to the last stored bit before rounding down,
+    // half of the range rounds to nearest, uniform random noise rounds stochastically
+    static constexpr uint32_t NEAREST_NOISE = 1u << 31;
+
+    EnvironmentPlane(Format format, int size) noexcept;
+
+    Format getFormat() const noexcept {
+        return m_format;
+    }
+
+    // unsafe, check index by yourself
+    double get(int index) const noexcept {
+        if (m_format == Format::DOUBLE) [[likely]] return m_doubles[index];
+        if (m_format == Format::FIXED_16) return m_values[index] * (1.0 / 256);
+        return decodeHalf(m_values[index]);
+    }
+
+    // unsafe, check index by yourself
+    void set(int index, double value, uint32_t noise = NEAREST_NOISE) noexcept {
+        switch (m_format) {
+        case Format::FIXED_16:
+            m_values[index] = encodeFixed16(value, noise);
+            break;
+        case Format::HALF:
+            m_values[index] = encodeHalf(value, noise);
+            break;
+        default:
+            m_doubles[index] = value;
+            break;
+        }
+    }
+
+    void fill(double value) noexcept;
+
+    // value that set would store
+    static double round(double value, Format format, uint32_t noise = NEAREST_NOISE) noexcept {
+        switch (format) {
+        case Format::FIXED_16:
+            return encodeFixed16(value, noise) * (1.0 / 256);
+        case Format::HALF:
+            return decodeHalf(encodeHalf(value, noise));
+        default:
+            return value;
+        }
+    }
+
+    static int getValueSize(Format format) noexcept {
+        return format == Format::DOUBLE ? sizeof(double) : sizeof(uint16_t);
+    }
+private:
+    Format m_format;
+    std::vector<double> m_doubles;
+    std::vector<uint16_t> m_values;
+
+    static uint16_t encodeFixed16(double value, uint32_t noise) noexcept;
+    static uint16_t encodeHalf(double value, uint32_t noise) noexcept;
+
+    static double decodeHalf(uint16_t half) noexcept {
+        uint32_t exponent = half >> 10;
+        uint32_t mantissa = half & 0x3FF;
+        if (exponent == 0) return mantissa * 0x1p-24;
+
+        // rebias the exponent and widen the mantissa to binary32
+        return std::bit_cast<float>((exponent + 112) << 23 | mantissa << 13);
+    }
+};
+
+#endif
@@ -12,13 +12,17 @@ You should have received a copy of the GNU General Public License along with JCy
 If not, see <https://www.gnu.org/licenses/>. */
 
 #include "Field.h"
-#include "FieldView.h"
 #include "Cell.h"
 #include "Bot.h"
 #include "Species.h"
+#include "SpeciesStore.h"
+#include "SpeciesCensus.h"
+#include "BotEvent.h"
 #include "Decision.h"
 #include "utility.h"
 #include "Topology.h"
+#include "EnvironmentPlane.h"
+#include "RandomBuffer.h"
 
 #include <SFML/Graphics.hpp>
 using sf::RenderTarget;
@@ -29,25 +33,31 @@ using sf::Vector2i;
 using sf::IntRect;
 using sf::Uint32;
 using sf::Uint8;
+using sf::Clock;
 
 #include <random>
-using std::uniform_int_distribution;
 using std::uniform_real_distribution;
 
 #include <vector>
 using std::vector;
 
+#include <array>
+using std::array;
+
 #include <algorithm>
+using std::min;
 using std::max;
 using std::clamp;
 
 #include <memory>
 using std::make_unique;
+using std::unique_ptr;
 using std::make_shared;
 using std::shared_ptr;
 
 #include <utility>
 using std::swap;
+using std::as_const;
 
 #include <limits>
 using std::numeric_limits;
@@ -57,232 +67,918 @@ using std::abs;
 
 #include <cassert>
 
-Field::Field(int width, int height, uint64_t seed) : 
-        m_width{width}, m_height{height}, m_topology{nullptr}, m_cells{width * height}, 
-        m_epoch{0},  m_settings{},
-        m_view{nullptr}, m_borderShape{{static_cast<float>(width), static_cast<float>(height)}}, 
-        m_randomEngine{seed} {
+using std::ssize;
+
+Field::ChunkData::ChunkData(EnvironmentPlane::Format format) noexcept : 
+    cells{}, decisions{}, neighbourMasks{}, grass{format, CHUNK_AREA}, organic{format, CHUNK_AREA}, 
+    newGrass{format, CHUNK_AREA}, newOrganic{format, CHUNK_AREA} {}
+
+Field::Field(int width, int height, uint64_t seed, EnvironmentPlane::Format environmentFormat) : 
+        m_width{width}, m_height{height}, m_topology{nullptr}, 
+        m_chunksX{(width + CHUNK_SIZE - 1) / CHUNK_SIZE}, 
+        m_chunksY{(height + CHUNK_SIZE - 1) / CHUNK_SIZE},
+        m_chunks(m_chunksX * m_chunksY), m_chunksTopologyId{-1}, 
+        m_activeChunks{}, m_unstableChunks{}, m_freeChunkData{}, 
+        m_environmentFormat{environmentFormat}, m_emptyCell{Vector2f(0.f, 0.f)},
+        m_epoch{0}, m_settings{}, m_cappedBots{0}, m_decisionsPerSecond{0.f}, 
+        m_decisionCache{}, m_lockstepInterpreter{}, m_speciesStore{}, m_census{}, 
+        m_events{}, m_observers{}, m_botIndex{}, m_nextBotId{1}, 
+        m_borderShape{{static_cast<float>(width), static_cast<float>(height)}}, 
+        m_randomBuffer{seed}, m_offspring{}, m_offspringPositions{}, m_firstOffspringId{0}, 
+        m_threadPool{}, m_fillBands{} {
     m_borderShape.setFillColor(Color::Transparent);
     m_borderShape.setOutlineColor(Color::Black);
     m_borderShape.setOutlineThickness(1.f);
 
-    for (int y = 0; y < m_height; ++ y) {
-        for (int x = 0; x < m_width; ++ x) {
-            emplace(x, y);
-            at(x, y).setGrass(255.0);
+    // buffers reused every epoch don't grow after the first one
+    m_activeChunks.reserve(m_chunks.size());
+    m_unstableChunks.reserve(m_chunks.size());
+    m_freeChunkData.reserve(MAX_FREE_CHUNK_DATA);
+
+    for (int chunkIndex = 0; chunkIndex < ssize(m_chunks); ++ chunkIndex)
+        storeUniform(chunkIndex, 255.0, 0.0, RoundingStage::EXTERNAL);
+}
+
+IntRect Field::getChunkRect(int chunkIndex) const noexcept {
+    int x = chunkIndex % m_chunksX * CHUNK_SIZE;
+    int y = chunkIndex / m_chunksX * CHUNK_SIZE;
+    return IntRect{x, y, min(CHUNK_SIZE, m_width - x), min(CHUNK_SIZE, m_height - y)};
+}
+
+void Field::allocateChunk(int chunkIndex) noexcept {
+    Chunk& chunk = m_chunks[chunkIndex];
+    if (m_freeChunkData.empty()) {
+        chunk.data = make_unique<ChunkData>(m_environmentFormat);
+    } else {
+        chunk.data = std::move(m_freeChunkData.back());
+        m_freeChunkData.pop_back();
+        chunk.data->newGrass.fill(0.0);
+        chunk.data->newOrganic.fill(0.0);
+    }
+    chunk.changed = true;
+    chunk.data->grass.fill(chunk.uniformGrass);
+    chunk.data->organic.fill(chunk.uniformOrganic);
+
+    IntRect rect = getChunkRect(chunkIndex);
+    for (int y = rect.top; y < rect.top + rect.height; ++ y)
+        for (int x = rect.left; x < rect.left + rect.width; ++ x) {
+            int index = getIndexInChunk(x, y);
+            chunk.data->cells[index] = Cell{Vector2f(x, y)};
+            chunk.data->decisions[index] = Decision{Decision::Action::SKIP, -1, 0.0};
+    }
+}
+
+void Field::updateChunkNeighbours() {
+    int topologyId = static_cast<int>(getTopology().getId());
+    if (topologyId == m_chunksTopologyId) return;
+    m_chunksTopologyId = topologyId;
+    wakeUpAll();
+
+    for (Chunk& chunk : m_chunks) 
+        chunk.neighbours.clear();
+
+    auto addNeighbour = [this] (int chunkIndex, int neighbourIndex) {
+        if (chunkIndex == neighbourIndex) return;
+
+        vector<int>& neighbours = m_chunks[chunkIndex].neighbours;
+        if (std::find(neighbours.begin(), neighbours.end(), neighbourIndex) == neighbours.end())
+            neighbours.push_back(neighbourIndex);
+    };
+
+    // only cells on the border of a chunk have neighbours in other chunks
+    for (int chunkIndex = 0; chunkIndex < ssize(m_chunks); ++ chunkIndex) {
+        IntRect rect = getChunkRect(chunkIndex);
+        for (int y = rect.top; y < rect.top + rect.height; ++ y)
+            for (int x = rect.left; x < rect.left + rect.width; ++ x) {
+                if (y != rect.top && y != rect.top + rect.height - 1 
+                    && x != rect.left && x != rect.left + rect.width - 1) continue;
+
+                for (int rotation = 0; rotation < 8; ++ rotation) {
+                    auto [dx, dy] = getOffsetForRotation(rotation);
+                    int xCurrent = x + dx, yCurrent = y + dy;
+                    if (!getTopology().makeIndicesSafe(xCurrent, yCurrent)) continue;
+
+                    int neighbourIndex = getChunkIndex(xCurrent, yCurrent);
+                    addNeighbour(chunkIndex, neighbourIndex);
+                    addNeighbour(neighbourIndex, chunkIndex);
+                }
         }
     }
 }
 
+bool Field::isStable(int chunkIndex) const noexcept {
+    const Chunk& chunk = m_chunks[chunkIndex];
+    for (int neighbourIndex : chunk.neighbours) {
+        const Chunk& neighbour = m_chunks[neighbourIndex];
+        if (neighbour.data 
+            || neighbour.uniformGrass != chunk.uniformGrass
+            || neighbour.uniformOrganic != chunk.uniformOrganic) 
+            return false;
+    }
+    return true;
+}
+
+void Field::collapseChunks() noexcept {
+    for (int chunkIndex = 0; chunkIndex < ssize(m_chunks); ++ chunkIndex) {
+        Chunk& chunk = m_chunks[chunkIndex];
+        // sleeping chunks haven't changed since the last check
+        if (!chunk.data || chunk.sleeping) continue;
+
+        IntRect rect = getChunkRect(chunkIndex);
+        const ChunkData& data = *chunk.data;
+        int first = getIndexInChunk(rect.left, rect.top);
+        double grass = data.grass.get(first);
+        double organic = data.organic.get(first);
+
+        bool uniform = true;
+        forEachStoredCell(rect, [&] (int, int, int index) {
+            uniform = !data.cells[index].hasBot() 
+                   && data.grass.get(index) == grass 
+                   && data.organic.get(index) == organic;
+            return uniform;
+        });
+        if (!uniform) continue;
+
+        // values are already rounded to the format
+        chunk.uniformGrass = grass;
+        chunk.uniformOrganic = organic;
+        if (ssize(m_freeChunkData) < MAX_FREE_CHUNK_DATA)
+            m_freeChunkData.push_back(std::move(chunk.data));
+        chunk.data.reset();
+    }
+}
+
 double Field::computeTotalEnergy() const {
+    if (m_settings.fixedPointEnergy) {
+        // integer sum doesn't depend on the order
+        int64_t units = 0;
+        auto toUnits = [] (double energy) {
+            return static_cast<int64_t>(energy / ENERGY_UNIT);
+        };
+
+        for (int chunkIndex = 0; chunkIndex < ssize(m_chunks); ++ chunkIndex) {
+            const Chunk& chunk = m_chunks[chunkIndex];
+            IntRect rect = getChunkRect(chunkIndex);
+            if (!chunk.data) {
+                units += rect.width * rect.height * (toUnits(chunk.uniformGrass) 
+                                                   + toUnits(chunk.uniformOrganic));
+                continue;
+            }
+
+            for (int y = rect.top; y < rect.top + rect.height; ++ y)
+                for (int x = rect.left; x < rect.left + rect.width; ++ x) {
+                    int index = getIndexInChunk(x, y);
+                    const Cell& cell = chunk.data->cells[index];
+                    units += toUnits(chunk.data->grass.get(index)) 
+                           + toUnits(chunk.data->organic.get(index));
+                    if (cell.hasBot()) 
+                        units += toUnits(cell.getBot().getEnergy());
+            }
+        }
+        return units * ENERGY_UNIT;
+    }
+
     double totalEnergy = 0.0;
-    for (const Cell& cell : m_cells) {
-        totalEnergy += cell.getGrass() + m_settings.organicGrassRatio * cell.getOrganic();
+    for (int chunkIndex = 0; chunkIndex < ssize(m_chunks); ++ chunkIndex) {
+        const Chunk& chunk = m_chunks[chunkIndex];
+        IntRect rect = getChunkRect(chunkIndex);
+        if (!chunk.data) {
+            totalEnergy += rect.width * rect.height * (chunk.uniformGrass 
+                + m_settings.organicGrassRatio * chunk.uniformOrganic);
+            continue;
+        }
 
-        if (cell.hasBot())
-            totalEnergy += cell.getBot().getEnergy() 
-                * m_settings.diedOrganicRatio * m_settings.organicGrassRatio;
+        for (int y = rect.top; y < rect.top + rect.height; ++ y)
+            for (int x = rect.left; x < rect.left + rect.width; ++ x) {
+                int index = getIndexInChunk(x, y);
+                const Cell& cell = chunk.data->cells[index];
+                totalEnergy += chunk.data->grass.get(index) 
+                             + m_settings.organicGrassRatio * chunk.data->organic.get(index);
+
+                if (cell.hasBot())
+                    totalEnergy += cell.getBot().getEnergy() 
+                        * m_settings.diedOrganicRatio * m_settings.organicGrassRatio;
+        }
     }
     return totalEnergy;
 }
 
 int Field::computePopulation() const {
     int population = 0;
-    for (const Cell& cell : m_cells)
-        if (cell.hasBot())
-            ++ population;
+    for (const Chunk& chunk : m_chunks)
+        if (chunk.data)
+            for (const Cell& cell : chunk.data->cells)
+                if (cell.hasBot())
+                    ++ population;
     return population;
 }
 
-std::vector<Decision> Field::makeDecisions() {
-    std::vector<Decision> decisions;
-    decisions.reserve(m_width * m_height);
-    for (Cell& cell : m_cells)
-        if (cell.hasBot())
-            decisions.push_back(cell.getBot().makeDecision(*this));
-        else
-            decisions.emplace_back(Decision::Action::SKIP, -1);
-    return decisions;
+void Field::makeDecisions() {
+    Clock clock;
+    m_cappedBots = 0;
+    m_decisionCache.resetCounters();
+    if (m_settings.memoizeDecisions) m_decisionCache.allocate();
+    bool lockstep = m_settings.lockstepDecisions && !m_settings.memoizeDecisions;
+    if (lockstep) m_lockstepInterpreter.allocate();
+    // masks are a snapshot, so tests don't depend on the order of decisions
+    for (int chunkIndex = 0; chunkIndex < ssize(m_chunks); ++ chunkIndex)
+        if (m_chunks[chunkIndex].data && !m_chunks[chunkIndex].sleeping) 
+            senseNeighbours(chunkIndex);
+
+    int population = 0;
+    for (int chunkIndex = 0; chunkIndex < ssize(m_chunks); ++ chunkIndex) {
+        Chunk& chunk = m_chunks[chunkIndex];
+        chunk.population = 0;
+        if (!chunk.data || chunk.sleeping) continue;
+
+        IntRect rect = getChunkRect(chunkIndex);
+        if (lockstep) {
+            makeLockstepDecisions(chunkIndex);
+        } else {
+            for (int y = rect.top; y < rect.top + rect.height; ++ y)
+                for (int x = rect.left; x < rect.left + rect.width; ++ x) {
+                    int index = getIndexInChunk(x, y);
+                    Cell& cell = chunk.data->cells[index];
+                    if (cell.hasBot()) {
+                        chunk.data->decisions[index] = cell.getBot().makeDecision(*this);
+                        if (chunk.data->decisions[index].capped) ++ m_cappedBots;
+                        ++ chunk.population;
+                    } else
+                        chunk.data->decisions[index] = Decision{Decision::Action::SKIP, -1, 0.0};
+            }
+        }
+        population += chunk.population;
+    }
+    float seconds = clock.getElapsedTime().asSeconds();
+    m_decisionsPerSecond = seconds > 0.f ? population / seconds : 0.f;
 }
 
-void Field::applyDecisions(std::vector<Decision>&& decisions) {
-    for (int y = 0; y < m_height; ++ y)
-        for (int x = 0; x < m_width; ++ x) {
-            int startRotation = uniform_int_distribution(0, 7)(m_randomEngine);
-            for (int rotation = startRotation; rotation < startRotation + 8; ++ rotation) {
-                auto [dx, dy] = getOffsetForRotation(rotation % 8);
-                int xCurrent = x + dx, yCurrent = y + dy;
-                int currentRotation = rotation;
-
-                if (!getTopology().makeIndicesSafe(xCurrent, yCurrent, currentRotation)) continue;
-                int rotationDelta = rotation % 8 - currentRotation;
-                int index = yCurrent * m_width + xCurrent;
-
-                Decision decision = decisions[index];
-                Cell& cell = m_cells[index];
-                if (!cell.isAlive() 
-                    || !areOpposite(decision.direction, currentRotation)) continue;
-
-                Bot& bot = cell.getBot();
-                switch (decision.action) {
-                case Decision::Action::MOVE:
-                    if (!at(x, y).hasBot()) {
-                        at(x, y).setBot(make_unique<Bot>(bot));
-                        int botRotation = at(x, y).getBot().getRotation();
-                        at(x, y).getBot().setRotation((botRotation + rotationDelta) % 8);
-
-                        if (m_view) m_view->handleBotMoved({xCurrent, yCurrent}, {x, y});
-                        cell.setShouldDie(true);
-                    }
-                    break;
-                case Decision::Action::MULTIPLY:
-                    if (!at(x, y).hasBot()) {
-                        shared_ptr<Species> parent = bot.getSpecies();
-                        shared_ptr<Species> offspring = parent->createMutant(
-                            m_randomEngine, m_epoch, m_settings.mutationChance);
-
-                        at(x, y).createBot((decision.direction + rotationDelta) % 8, 
-                            m_settings.startEnergy, offspring);
-                    } else {
-                        decisions[index].organic += m_settings.usedEnergyOrganicRatio 
-                                                  * m_settings.startEnergy;
-                    }
-                    break;
-                case Decision::Action::ATTACK:
-                    if (at(x, y).isAlive()) {
-                        bot.setEnergy(bot.getEnergy()
-                            + m_settings.killGainRatio * max(at(x, y).getBot().getEnergy(), 0.0));
-                        decision.organic += m_settings.killOrganicRatio 
-                            * (1 - m_settings.killGainRatio) * max(at(x, y).getBot().getEnergy(), 0.0);
-                        at(x, y).setShouldDie(true);
-                        bot.handleKill();
+void Field::makeLockstepDecisions(int chunkIndex) noexcept {
+    Chunk& chunk = m_chunks[chunkIndex];
+    IntRect rect = getChunkRect(chunkIndex);
+    m_lockstepInterpreter.clear();
+    for (int y = rect.top; y < rect.top + rect.height; ++ y)
+        for (int x = rect.left; x < rect.left + rect.width; ++ x) {
+            int index = getIndexInChunk(x, y);
+            Cell& cell = chunk.data->cells[index];
+            chunk.data->decisions[index] = Decision{Decision::Action::SKIP, -1, 0.0};
+            if (!cell.hasBot()) continue;
+
+            Bot::DecisionState state;
+            if (cell.getBot().startDecision(state, *this))
+                m_lockstepInterpreter.add(cell.getBot(), state, index);
+            else
+                chunk.data->decisions[index] = state.decision;
+            ++ chunk.population;
+        }
+
+    m_lockstepInterpreter.run(*this);
+    // the rest is interpreted in the order of cells, as random numbers were drawn without lanes
+    for (int i = 0; i < m_lockstepInterpreter.getSize(); ++ i) {
+        int index = m_lockstepInterpreter.getIndex(i);
+        chunk.data->decisions[index] 
+            = m_lockstepInterpreter.getBot(i).finishDecision(m_lockstepInterpreter.getState(i), *this);
+        if (chunk.data->decisions[index].capped) ++ m_cappedBots;
+    }
+}
+
+void Field::senseNeighbours(int chunkIndex) noexcept {
+    static const array<Vector2i, 8> offsets = [] {
+        array<Vector2i, 8> offsets;
+        for (int direction = 0; direction < 8; ++ direction)
+            offsets[direction] = getOffsetForRotation(direction);
+        return offsets;
+    }();
+
+    ChunkData& data = *m_chunks[chunkIndex].data;
+    IntRect rect = getChunkRect(chunkIndex);
+    forEachStoredCell(rect, [&] (int x, int y, int index) {
+        if (!data.cells[index].hasBot()) return;
+
+        // only cells on the border of the chunk can have neighbours wrapped by the topology,
+        // inner ones are sensed without branches, occupancy is hard to predict
+        bool inner = x > rect.left && x < rect.left + rect.width - 1 
+                  && y > rect.top && y < rect.top + rect.height - 1;
+        uint8_t existing = 0;
+        uint8_t occupied = 0;
+        for (int direction = 0; direction < 8; ++ direction) {
+            int xNeighbour = x + offsets[direction].x, yNeighbour = y + offsets[direction].y;
+            const Cell* neighbour;
+            if (inner) {
+                neighbour = &data.cells[getIndexInChunk(xNeighbour, yNeighbour)];
+            } else {
+                if (!getTopology().makeIndicesSafe(xNeighbour, yNeighbour)) continue;
+                neighbour = &as_const(*this).at(xNeighbour, yNeighbour);
+            }
+            existing |= static_cast<uint8_t>(1 << direction);
+            occupied |= static_cast<uint8_t>(neighbour->hasBot() << direction);
+        }
+        data.neighbourMasks[index] = {static_cast<uint8_t>(existing & ~occupied), occupied};
+    });
+}
+
+void Field::applyDecisions() {
+    m_offspring.clear();
+    m_offspringPositions.clear();
+    m_firstOffspringId = m_nextBotId;
+
+    // only chunks with bots and their neighbours can change
+    m_activeChunks.clear();
+    for (int chunkIndex = 0; chunkIndex < ssize(m_chunks); ++ chunkIndex) {
+        const Chunk& chunk = m_chunks[chunkIndex];
+        bool active = chunk.population > 0;
+        for (int neighbourIndex : chunk.neighbours)
+            if (m_chunks[neighbourIndex].population > 0) active = true;
+
+        if (active) m_activeChunks.push_back(chunkIndex);
+    }
+
+    for (int chunkIndex : m_activeChunks) {
+        IntRect rect = getChunkRect(chunkIndex);
+        for (int y = rect.top; y < rect.top + rect.height; ++ y)
+            for (int x = rect.left; x < rect.left + rect.width; ++ x) {
+                int startRotation = static_cast<int>(m_randomBuffer.getBelow(8));
+                for (int rotation = startRotation; rotation < startRotation + 8; ++ rotation) {
+                    auto [dx, dy] = getOffsetForRotation(rotation % 8);
+                    int xCurrent = x + dx, yCurrent = y + dy;
+                    int currentRotation = rotation;
+
+                    if (!getTopology().makeIndicesSafe(xCurrent, yCurrent, currentRotation)) continue;
+                    int rotationDelta = rotation % 8 - currentRotation;
+
+                    Chunk& chunk = m_chunks[getChunkIndex(xCurrent, yCurrent)];
+                    if (!chunk.data) continue;
+                    int index = getIndexInChunk(xCurrent, yCurrent);
+
+                    Decision decision = chunk.data->decisions[index];
+                    Cell& cell = chunk.data->cells[index];
+                    if (!cell.isAlive() 
+                        || !areOpposite(decision.direction, currentRotation)) continue;
+
+                    Bot& bot = cell.getBot();
+                    switch (decision.action) {
+                    case Decision::Action::MOVE:
+                        if (!as_const(*this).at(x, y).hasBot()) {
+                            at(x, y).setBot(make_unique<Bot>(bot));
+                            int botRotation = at(x, y).getBot().getRotation();
+                            at(x, y).getBot().setRotation((botRotation + rotationDelta) % 8);
+
+                            addEvent(BotEvent::Type::MOVED, {x, y}, {xCurrent, yCurrent}, bot);
+                            cell.setShouldDie(true);
+                        }
+                        break;
+                    case Decision::Action::MULTIPLY:
+                        if (!as_const(*this).at(x, y).hasBot()) {
+                            m_offspring.push_back({bot.getSpecies(), 
+                                                   m_speciesStore[bot.getSpecies()], 
+                                                   false, bot.getSpecies()});
+                            m_offspringPositions.push_back({x, y});
+
+                            at(x, y).createBot((decision.direction + rotationDelta) % 8, 
+                                getOffspringEnergy(), bot.getSpecies());
+                            at(x, y).getBot().setId(m_nextBotId ++);
+                            addEvent(BotEvent::Type::BORN, {x, y}, {xCurrent, yCurrent}, 
+                                     at(x, y).getBot(), DeathCause::NONE, bot.getId());
+                            chunk.data->decisions[index].action = Decision::Action::SKIP;
+                        } else if (!m_settings.fixedPointEnergy) {
+                            chunk.data->decisions[index].organic += m_settings.usedEnergyOrganicRatio 
+                                                                  * m_settings.startEnergy;
+                        }
+                        break;
+                    case Decision::Action::ATTACK:
+                        // near the apex of a cone a bot can face itself
+                        if (as_const(*this).at(x, y).isAlive() && (x != xCurrent || y != yCurrent)) {
+                            Cell& target = at(x, y);
+                            double energy = max(target.getBot().getEnergy(), 0.0);
+                            if (m_settings.fixedPointEnergy) {
+                                double gain = quantizeEnergy(min(m_settings.killGainRatio, 1.f) * energy);
+                                bot.setEnergy(bot.getEnergy() + gain);
+                                storeOrganic(getChunkIndex(x, y), getIndexInChunk(x, y), 
+                                             getOrganic(x, y) + energy - gain, RoundingStage::KILL);
+                            } else {
+                                bot.setEnergy(bot.getEnergy() + m_settings.killGainRatio * energy);
+                                decision.organic += m_settings.killOrganicRatio 
+                                    * (1 - m_settings.killGainRatio) * energy;
+                            }
+                            target.setShouldDie(true);
+                            bot.handleKill();
+                            addEvent(BotEvent::Type::KILLED, {x, y}, {xCurrent, yCurrent}, 
+                                     target.getBot(), DeathCause::KILLED);
+                        }
+                        break;
                     }
-                    break;
                 }
-            }
 
-            if (decisions[y * m_width + x].action == Decision::Action::DIE 
-                    && at(x, y).isAlive()) {
-                at(x, y).setShouldDie(true);
-                decisions[y * m_width + x].organic += m_settings.diedOrganicRatio 
-                                                    * max(at(x, y).getBot().getEnergy(), 0.0);
+                // uniform chunks have no bots and no organic from decisions
+                if (!isAllocated(x, y)) continue;
+
+                int chunkIndex = getChunkIndex(x, y);
+                int index = getIndexInChunk(x, y);
+                Chunk& chunk = m_chunks[chunkIndex];
+                Decision& decision = chunk.data->decisions[index];
+                Cell& cell = chunk.data->cells[index];
+                if (decision.action == Decision::Action::DIE && cell.isAlive()) {
+                    cell.setShouldDie(true);
+                    addEvent(BotEvent::Type::DIED, {x, y}, {x, y}, cell.getBot(), decision.death);
+                    double energy = max(cell.getBot().getEnergy(), 0.0);
+                    if (m_settings.fixedPointEnergy)
+                        decision.organic += energy;
+                    else
+                        decision.organic += m_settings.diedOrganicRatio * energy;
+                }
+
+                storeOrganic(chunkIndex, index, chunk.data->organic.get(index) + decision.organic, 
+                             RoundingStage::DECISIONS);
+        }
+    }
+
+    if (m_settings.fixedPointEnergy) {
+        // energy reserved for offspring that wasn't born returns to the field
+        for (int chunkIndex : m_activeChunks) {
+            Chunk& chunk = m_chunks[chunkIndex];
+            if (!chunk.data) continue;
+
+            IntRect rect = getChunkRect(chunkIndex);
+            for (int y = rect.top; y < rect.top + rect.height; ++ y)
+                for (int x = rect.left; x < rect.left + rect.width; ++ x) {
+                    int index = getIndexInChunk(x, y);
+                    if (chunk.data->decisions[index].action == Decision::Action::MULTIPLY)
+                        storeOrganic(chunkIndex, index, 
+                                     chunk.data->organic.get(index) + getOffspringEnergy(), 
+                                     RoundingStage::OFFSPRING);
             }
+        }
+    }
+}
 
-            at(x, y).setOrganic(at(x, y).getOrganic() + decisions[y * m_width + x].organic);
+void Field::mutateOffspring() {
+    // streams depend only on the epoch seed and the order of births, not on the threads
+    uint64_t seed = m_randomBuffer();
+    m_threadPool.run(ssize(m_offspring), [this, seed] (int i) {
+        SpeciesStore::Mutant& offspring = m_offspring[i];
+        SplitMix64 randomEngine{splitMix64(seed + i)};
+        Species mutant;
+        offspring.mutated = offspring.species.createMutant(randomEngine, m_epoch, 
+                                                           m_settings.mutationChance, mutant);
+        if (offspring.mutated) offspring.species = mutant;
+    });
+    m_speciesStore.createMutants(m_offspring);
+
+    for (int i = 0; i < ssize(m_offspring); ++ i) {
+        Vector2i position = m_offspringPositions[i];
+        at(position.x, position.y).getBot().setSpecies(m_offspring[i].handle);
     }
+    // offspring can be killed in the epoch they were born
+    for (BotEvent& event : m_events)
+        if (event.botId >= m_firstOffspringId)
+            event.species = m_offspring[event.botId - m_firstOffspringId].handle;
 }
 
-void Field::updateGrass() {
-    for (int y = 0; y < m_height; ++ y)
-        for (int x = 0; x < m_width; ++ x) {
-            int index = y * m_width + x;
-            at(x, y).setOrganic((1 - m_settings.organicSpoil) * at(x, y).getOrganic());
-
-            at(x, y).setOrganic(at(x, y).getOrganic()
-                + m_settings.grassDeath * m_settings.deadGrassOrganicRatio * at(x, y).getGrass());
-            at(x, y).setGrass((1 - m_settings.grassDeath) * at(x, y).getGrass());
-
-            at(x, y).setGrass(at(x, y).getGrass()
-                + m_settings.grassGrowth * m_settings.organicGrassRatio * at(x, y).getOrganic());
-            at(x, y).setOrganic((1 - m_settings.grassGrowth) * at(x, y).getOrganic());
+void Field::updateGrass(double& grass, double& organic) const noexcept {
+    if (m_settings.fixedPointEnergy) {
+        updateGrassFixedPoint(grass, organic);
+        return;
+    }
+
+    organic = (1 - m_settings.organicSpoil) * organic;
+
+    organic = organic + m_settings.grassDeath * m_settings.deadGrassOrganicRatio * grass;
+    grass = (1 - m_settings.grassDeath) * grass;
+
+    grass = grass + m_settings.grassGrowth * m_settings.organicGrassRatio * organic;
+    organic = (1 - m_settings.grassGrowth) * organic;
+}
+
+void Field::updateGrassFixedPoint(double& grass, double& organic) const noexcept {
+    // spoiled organic returns to grass, so nothing leaves the field
+    double spoiled = quantizeEnergy(m_settings.organicSpoil * organic);
+    double died = quantizeEnergy(m_settings.grassDeath * grass);
+    organic = organic - spoiled + died;
+    grass = grass + spoiled - died;
+
+    double grown = quantizeEnergy(m_settings.grassGrowth * organic);
+    organic = organic - grown;
+    grass = grass + grown;
+}
+
+void Field::updateGrass(int chunkIndex) noexcept {
+    Chunk& chunk = m_chunks[chunkIndex];
+    if (!chunk.data) {
+        double grass = chunk.uniformGrass;
+        double organic = chunk.uniformOrganic;
+        updateGrass(grass, organic);
+
+        // stable uniform chunk is only clamped by diffusion
+        if (hasChanged(chunk.uniformGrass, clampEnvironment(grass))
+            || hasChanged(chunk.uniformOrganic, clampEnvironment(organic)))
+            chunk.changing = true;
+        storeUniform(chunkIndex, grass, organic, RoundingStage::GROWTH);
+        return;
     }
+
+    // diffusion compares with environment from the start of the epoch
+    ChunkData& data = *chunk.data;
+    data.newGrass = data.grass;
+    data.newOrganic = data.organic;
+
+    forEachStoredCell(getChunkRect(chunkIndex), [&] (int, int, int index) {
+        double grass = data.grass.get(index);
+        double organic = data.organic.get(index);
+        updateGrass(grass, organic);
+
+        storeGrass(chunkIndex, index, grass, RoundingStage::GROWTH);
+        storeOrganic(chunkIndex, index, organic, RoundingStage::GROWTH);
+    });
+}
+
+void Field::updateGrass() {
+    for (int chunkIndex = 0; chunkIndex < ssize(m_chunks); ++ chunkIndex)
+        if (!m_chunks[chunkIndex].sleeping) 
+            updateGrass(chunkIndex);
 }
 
 void Field::diffuseGrass() {
-    vector<double> newGrass;
-    newGrass.reserve(m_width * m_height);
-    for (int y = 0; y < m_height; ++ y)
-        for (int x = 0; x < m_width; ++ x)
-            newGrass.push_back(at(x, y).getGrass());
-
-    vector<double> newOrganic;
-    newOrganic.reserve(m_width * m_height);
-    for (int y = 0; y < m_height; ++ y)
-        for (int x = 0; x < m_width; ++ x)
-            newOrganic.push_back(at(x, y).getOrganic());
-
-    for (int y = 0; y < m_height; ++ y)
-        for (int x = 0; x < m_width; ++ x)
+    // uniform chunks next to other environment start to differ
+    m_unstableChunks.clear();
+    for (int chunkIndex = 0; chunkIndex < ssize(m_chunks); ++ chunkIndex)
+        if (!m_chunks[chunkIndex].data && !isStable(chunkIndex)) 
+            m_unstableChunks.push_back(chunkIndex);
+
+    for (int chunkIndex : m_unstableChunks)
+        allocateChunk(chunkIndex);
+
+    // stable uniform chunk keeps its values, so only clamp them
+    for (int chunkIndex = 0; chunkIndex < ssize(m_chunks); ++ chunkIndex) {
+        const Chunk& chunk = m_chunks[chunkIndex];
+        if (chunk.data) continue;
+
+        storeUniform(chunkIndex, clampEnvironment(chunk.uniformGrass), 
+                     clampEnvironment(chunk.uniformOrganic), RoundingStage::DIFFUSION);
+    }
+
+    // sleeping chunk has to diffuse again if something around it changed,
+    // it skipped updateGrass, so catch up first
+    for (int chunkIndex = 0; chunkIndex < ssize(m_chunks); ++ chunkIndex) {
+        Chunk& chunk = m_chunks[chunkIndex];
+        if (!chunk.sleeping) continue;
+
+        for (int neighbourIndex : chunk.neighbours)
+            if (m_chunks[neighbourIndex].changed) chunk.sleeping = false;
+
+        if (!chunk.sleeping) updateGrass(chunkIndex);
+    }
+
+    // every cell gets spread part of the difference with each neighbour,
+    // so a cell with all neighbours equal to it stays exactly the same
+    for (int chunkIndex = 0; chunkIndex < ssize(m_chunks); ++ chunkIndex) {
+        Chunk& chunk = m_chunks[chunkIndex];
+        if (!chunk.data || chunk.sleeping) continue;
+
+        ChunkData& data = *chunk.data;
+        forEachStoredCell(getChunkRect(chunkIndex), [&] (int x, int y, int index) {
+            double cellGrass = data.grass.get(index);
+            double cellOrganic = data.organic.get(index);
+
+            double grassFlow = 0.0;
+            double organicFlow = 0.0;
             for (int rotation = 0; rotation < 8; ++ rotation) {
                 auto [dx, dy] = getOffsetForRotation(rotation);
                 int xCurrent = x + dx, yCurrent = y + dy;
-                int currentRotation = rotation;
 
-                if (!getTopology().makeIndicesSafe(xCurrent, yCurrent, currentRotation)) 
+                if (!getTopology().makeIndicesSafe(xCurrent, yCurrent)) 
                     continue;
-                
-                int rotationDelta = rotation - currentRotation;
-                int index = yCurrent * m_width + xCurrent;
 
-                newGrass[y * m_width + x] += m_settings.grassSpread * at(xCurrent, yCurrent).getGrass();
-                newGrass[index] -= m_settings.grassSpread * at(xCurrent, yCurrent).getGrass();
+                double neighbourGrass = getGrass(xCurrent, yCurrent);
+                double neighbourOrganic = getOrganic(xCurrent, yCurrent);
+                if (m_settings.fixedPointEnergy) {
+                    // neighbour computes exactly opposite flow, so diffusion is conservative
+                    grassFlow += quantizeEnergy(m_settings.grassSpread 
+                                                * (neighbourGrass - cellGrass));
+                    organicFlow += quantizeEnergy(m_settings.organicSpread 
+                                                  * (neighbourOrganic - cellOrganic));
+                } else {
+                    grassFlow += neighbourGrass - cellGrass;
+                    organicFlow += neighbourOrganic - cellOrganic;
+                }
+            }
+
+            if (!m_settings.fixedPointEnergy) {
+                grassFlow *= m_settings.grassSpread;
+                organicFlow *= m_settings.organicSpread;
+            }
+
+            // compared with the stored value, so rounding alone can't keep a chunk awake
+            uint32_t grassNoise = getRoundingNoise(chunkIndex, index, 
+                                                   RoundingStage::DIFFUSION, false);
+            uint32_t organicNoise = getRoundingNoise(chunkIndex, index, 
+                                                     RoundingStage::DIFFUSION, true);
+            double grass = EnvironmentPlane::round(clampEnvironment(cellGrass + grassFlow), 
+                                                   m_environmentFormat, grassNoise);
+            double organic = EnvironmentPlane::round(clampEnvironment(cellOrganic + organicFlow), 
+                                                     m_environmentFormat, organicNoise);
+            if (hasChanged(data.newGrass.get(index), grass)
+                || hasChanged(data.newOrganic.get(index), organic))
+                chunk.changing = true;
+
+            data.newGrass.set(index, grass);
+            data.newOrganic.set(index, organic);
+        });
+    }
+
+    for (Chunk& chunk : m_chunks) {
+        if (!chunk.data || chunk.sleeping) continue;
+
+        swap(chunk.data->grass, chunk.data->newGrass);
+        swap(chunk.data->organic, chunk.data->newOrganic);
+    }
+}
+
+double Field::clampEnvironment(double value) const noexcept {
+    if (m_settings.fixedPointEnergy) return value;
+    return clamp(value, 0.0, 255.0);
+}
+
+bool Field::hasChanged(double before, double after) const noexcept {
+    if (m_settings.exactSleep) return before != after;
+    return abs(after - before) >= m_settings.sleepEpsilon;
+}
+
+uint32_t Field::getRoundingNoise(int chunkIndex, int index, 
+                                 RoundingStage stage, bool organic) const noexcept {
+    if (!m_settings.stochasticRounding || m_environmentFormat == EnvironmentPlane::Format::DOUBLE) 
+        return EnvironmentPlane::NEAREST_NOISE;
+
+    // depends only on the cell, the epoch and the stage, not on the order of updates
+    uint64_t salt = static_cast<uint64_t>(m_epoch) * 16 + static_cast<int>(stage) * 2 + organic;
+    uint64_t cell = static_cast<uint64_t>(chunkIndex) * CHUNK_AREA + index;
+    return static_cast<uint32_t>(splitMix64(salt * m_chunks.size() * CHUNK_AREA + cell) >> 32);
+}
+
+void Field::storeGrass(int chunkIndex, int index, double grass, RoundingStage stage) noexcept {
+    m_chunks[chunkIndex].data->grass.set(index, grass, 
+                                         getRoundingNoise(chunkIndex, index, stage, false));
+}
+
+void Field::storeOrganic(int chunkIndex, int index, double organic, RoundingStage stage) noexcept {
+    m_chunks[chunkIndex].data->organic.set(index, organic, 
+                                           getRoundingNoise(chunkIndex, index, stage, true));
+}
+
+void Field::storeUniform(int chunkIndex, double grass, double organic, RoundingStage stage) noexcept {
+    Chunk& chunk = m_chunks[chunkIndex];
+    chunk.uniformGrass = EnvironmentPlane::round(grass, m_environmentFormat, 
+                                                 getRoundingNoise(chunkIndex, 0, stage, false));
+    chunk.uniformOrganic = EnvironmentPlane::round(organic, m_environmentFormat, 
+                                                   getRoundingNoise(chunkIndex, 0, stage, true));
+}
+
+void Field::setGrass(int x, int y, double grass) noexcept {
+    at(x, y);
+    storeGrass(getChunkIndex(x, y), getIndexInChunk(x, y), grass, RoundingStage::EXTERNAL);
+}
 
-                newOrganic[y * m_width + x] += m_settings.organicSpread 
-                                                * at(xCurrent, yCurrent).getOrganic();
-                newOrganic[index] -= m_settings.organicSpread * at(xCurrent, yCurrent).getOrganic();
+void Field::setOrganic(int x, int y, double organic) noexcept {
+    at(x, y);
+    storeOrganic(getChunkIndex(x, y), getIndexInChunk(x, y), organic, RoundingStage::EXTERNAL);
+}
+
+void Field::updateSleeping() noexcept {
+    for (Chunk& chunk : m_chunks) {
+        if (!m_settings.sleepChunks || !chunk.data) 
+            chunk.sleeping = false;
+        else if (!chunk.sleeping) 
+            chunk.sleeping = !chunk.changed && !chunk.changing;
+
+        // neighbours will see the new environment during the next epoch
+        chunk.changed = chunk.changing;
+        chunk.changing = false;
     }
+}
 
-    for (int y = 0; y < m_height; ++ y)
-        for (int x = 0; x < m_width; ++ x)
-            at(x, y).setGrass(clamp(newGrass[y * m_width + x], 0.0, 255.0));
-    
-    for (int y = 0; y < m_height; ++ y)
-        for (int x = 0; x < m_width; ++ x)
-            at(x, y).setOrganic(clamp(newOrganic[y * m_width + x], 0.0, 255.0));
+void Field::wakeUpAll() noexcept {
+    for (Chunk& chunk : m_chunks) {
+        chunk.sleeping = false;
+        chunk.changed = true;
+    }
 }
 
 void Field::fixEnergy(double shouldBe) {
     double deltaEnergy = computeTotalEnergy() - shouldBe;
     double deltaOrganic = deltaEnergy / m_settings.organicGrassRatio;
-    for (Cell& cell : m_cells)
-        cell.setOrganic(clamp(cell.getOrganic() - deltaOrganic / getArea(), 0.0, 255.0));
+    if (deltaOrganic != 0.0) wakeUpAll();
+
+    auto fix = [&] (double organic) {
+        return clamp(organic - deltaOrganic / getArea(), 0.0, 255.0);
+    };
+
+    for (int chunkIndex = 0; chunkIndex < ssize(m_chunks); ++ chunkIndex) {
+        Chunk& chunk = m_chunks[chunkIndex];
+        storeUniform(chunkIndex, chunk.uniformGrass, fix(chunk.uniformOrganic), 
+                     RoundingStage::ENERGY_FIX);
+        if (!chunk.data) continue;
+
+        forEachStoredCell(getChunkRect(chunkIndex), [&] (int, int, int index) {
+            storeOrganic(chunkIndex, index, fix(chunk.data->organic.get(index)), 
+                         RoundingStage::ENERGY_FIX);
+        });
+    }
+}
+
+void Field::removeDead() noexcept {
+    for (Chunk& chunk : m_chunks)
+        if (chunk.data)
+            for (Cell& cell : chunk.data->cells)
+                cell.checkShouldDie();
+}
+
+void Field::updateBotIndex() {
+    for (const BotEvent& event : m_events) {
+        switch (event.type) {
+        case BotEvent::Type::BORN:
+        case BotEvent::Type::MOVED:
+            m_botIndex.set(event.botId, event.position.y * m_width + event.position.x);
+            break;
+        case BotEvent::Type::DIED:
+        case BotEvent::Type::KILLED:
+            m_botIndex.erase(event.botId);
+            break;
+        }
+    }
+}
+
+void Field::addObserver(BotEventObserver* observer) {
+    m_observers.push_back(observer);
+}
+
+void Field::removeObserver(BotEventObserver* observer) noexcept {
+    std::erase(m_observers, observer);
 }
 
-void Field::notifyDied() {
-    for (int y = 0; y < m_height; ++ y)
-        for (int x = 0; x < m_width; ++ x)
-            if (at(x, y).checkShouldDie())
-                if (m_view) 
-                    m_view->handleBotDied({x, y});
+void Field::dispatchEvents() {
+    updateBotIndex();
+    m_census.handleBotEvents(m_events, m_epoch);
+    for (BotEventObserver* observer : m_observers)
+        observer->handleBotEvents(m_events, m_epoch);
+    m_events.clear();
 }
 
 void Field::update() {
+    updateChunkNeighbours();
+    m_speciesStore.setEpoch(m_epoch);
+    m_speciesStore.setDeltaGenomes(m_settings.deltaGenomes);
+
     double totalEnergy = 0.f;
-    if (m_settings.preserveEnergy)
+    if (m_settings.preserveEnergy && !m_settings.fixedPointEnergy)
         totalEnergy = computeTotalEnergy();
 
-    applyDecisions(makeDecisions());
+    makeDecisions();
+    applyDecisions();
+    mutateOffspring();
 
     updateGrass();
     diffuseGrass();
 
-    if (m_settings.preserveEnergy) 
+    // fixed point energy is preserved by itself
+    if (m_settings.preserveEnergy && !m_settings.fixedPointEnergy) 
         fixEnergy(totalEnergy);
 
-    notifyDied();
+    removeDead();
+    dispatchEvents();
+    collapseChunks();
+    updateSleeping();
+    if (m_epoch % SPECIES_COLLECTION_PERIOD == 0) collectSpecies();
 
     ++ m_epoch;
 }
 
 Field::Statistics Field::computeStatistics() const {
-    return Statistics(computePopulation(), computeTotalEnergy());
+    return Statistics(computePopulation(), computeTotalEnergy(), 
+                      countAllocatedChunks(), countSleepingChunks(), 
+                      m_speciesStore.getAliveCount(), m_cappedBots, 
+                      m_decisionCache.getHitRate(), m_decisionsPerSecond);
+}
+
+void Field::collectSpecies() noexcept {
+    m_speciesStore.beginCollection();
+    for (const Chunk& chunk : m_chunks)
+        if (chunk.data)
+            for (const Cell& cell : chunk.data->cells)
+                if (cell.hasBot())
+                    m_speciesStore.mark(cell.getBot().getSpecies());
+    m_speciesStore.endCollection();
+    m_decisionCache.removeExtinct(m_speciesStore);
+}
+
+int Field::countAllocatedChunks() const noexcept {
+    return std::ranges::count_if(m_chunks, [] (const Chunk& chunk) {
+        return static_cast<bool>(chunk.data);
+    });
+}
+
+int Field::countSleepingChunks() const noexcept {
+    return std::ranges::count_if(m_chunks, [] (const Chunk& chunk) {
+        return chunk.sleeping;
+    });
+}
+
+double Field::getOffspringEnergy() const noexcept {
+    if (!m_settings.fixedPointEnergy) return m_settings.startEnergy;
+    return quantizeEnergy(min(m_settings.startEnergy, m_settings.multiplyCost));
 }
 
-void Field::randomFill(float density) noexcept {
+void Field::roundEnergy() noexcept {
+    for (int chunkIndex = 0; chunkIndex < ssize(m_chunks); ++ chunkIndex) {
+        Chunk& chunk = m_chunks[chunkIndex];
+        storeUniform(chunkIndex, quantizeEnergy(chunk.uniformGrass), 
+                     quantizeEnergy(chunk.uniformOrganic), RoundingStage::EXTERNAL);
+        if (!chunk.data) continue;
+
+        forEachStoredCell(getChunkRect(chunkIndex), [&] (int, int, int index) {
+            storeGrass(chunkIndex, index, quantizeEnergy(chunk.data->grass.get(index)), 
+                       RoundingStage::EXTERNAL);
+            storeOrganic(chunkIndex, index, quantizeEnergy(chunk.data->organic.get(index)), 
+                         RoundingStage::EXTERNAL);
+
+            Cell& cell = chunk.data->cells[index];
+            if (cell.hasBot())
+                cell.getBot().setEnergy(quantizeEnergy(max(cell.getBot().getEnergy(), 0.0)));
+        });
+    }
+    wakeUpAll();
+}
+
+void Field::randomFill(float density) {
     clear();
 
-    for (int x = 0; x < m_width; ++ x) 
-        for (int y = 0; y < m_height; ++ y)
-            if (uniform_real_distribution<float>(0.f, 1.f)(m_randomEngine) < density)
-                at(x, y).setBot(make_unique<Bot>(Bot::createRandom({x, y}, m_randomEngine)));
+    // genomes are generated and analysed in parallel, every band of rows from its own stream,
+    // species and bots are created in order, so the result doesn't depend on the threads
+    uint64_t seed = m_randomBuffer();
+    int bandCount = (m_height + FILL_BAND_HEIGHT - 1) / FILL_BAND_HEIGHT;
+    int windowSize = min(bandCount, m_threadPool.getThreadCount() * FILL_BANDS_PER_THREAD);
+    if (ssize(m_fillBands) < windowSize) m_fillBands.resize(windowSize);
+    for (int firstBand = 0; firstBand < bandCount; firstBand += windowSize) {
+        int count = min(windowSize, bandCount - firstBand);
+        m_threadPool.run(count, [this, density, seed, firstBand] (int i) {
+            int band = firstBand + i;
+            RandomBuffer randomBuffer{splitMix64(seed + band)};
+            vector<RandomBot>& bots = m_fillBands[i];
+            bots.clear();
+            for (int y = band * FILL_BAND_HEIGHT; y < min((band + 1) * FILL_BAND_HEIGHT, m_height); ++ y)
+                for (int x = 0; x < m_width; ++ x)
+                    if (uniform_real_distribution<float>(0.f, 1.f)(randomBuffer) < density) {
+                        RandomBot& bot = bots.emplace_back();
+                        bot.position = {x, y};
+                        bot.rotation = static_cast<int>(randomBuffer.getBelow(8));
+                        bot.species = Species::createRandom(randomBuffer);
+                        bot.controlFlow = ControlFlow{bot.species};
+                    }
+        });
+
+        for (int i = 0; i < count; ++ i)
+            for (const RandomBot& bot : m_fillBands[i]) {
+                SpeciesHandle species = m_speciesStore.create(bot.species, bot.controlFlow);
+                placeBotSilently(bot.position.x, bot.position.y, 
+                                 make_unique<Bot>(bot.position, bot.rotation, 10.0, species));
+            }
+    }
+    dispatchEvents();
+}
+
+void Field::placeBotSilently(int x, int y, unique_ptr<Bot>&& bot) {
+    Cell& cell = at(x, y);
+    if (cell.hasBot()) 
+        addEvent(BotEvent::Type::DIED, {x, y}, {x, y}, cell.getBot(), DeathCause::REMOVED);
+    // copies of the same bot placed twice are different bots
+    bot->setId(m_nextBotId ++);
+    addEvent(BotEvent::Type::BORN, {x, y}, {x, y}, *bot);
+    cell.setBot(std::move(bot));
+}
+
+void Field::placeBot(int x, int y, unique_ptr<Bot>&& bot) {
+    placeBotSilently(x, y, std::move(bot));
+    dispatchEvents();
+}
+
+void Field::deleteBot(int x, int y) {
+    if (!isAllocated(x, y) || !as_const(*this).at(x, y).hasBot()) return;
+
+    Cell& cell = at(x, y);
+    addEvent(BotEvent::Type::DIED, {x, y}, {x, y}, cell.getBot(), DeathCause::REMOVED);
+    cell.deleteBot();
+    dispatchEvents();
 }
 
 void Field::clear() noexcept {
     m_epoch = 0;
-
-    for (Cell& cell : m_cells) {
-        cell.deleteBot();
-        cell.setGrass(255.0);
-        cell.setOrganic(0.0);
+    m_speciesStore.setEpoch(m_epoch);
+    m_census.clear();
+    m_botIndex.clear();
+
+    for (int chunkIndex = 0; chunkIndex < ssize(m_chunks); ++ chunkIndex) {
+        Chunk& chunk = m_chunks[chunkIndex];
+        chunk.data.reset();
+        chunk.sleeping = false;
+        chunk.changed = true;
+        storeUniform(chunkIndex, 255.0, 0.0, RoundingStage::EXTERNAL);
     }
 }
@@ -15,14 +15,24 @@ If not, see <https://www.gnu.org/licenses/>. */
 #define FIELD_H_
 
 #include "Cell.h"
+#include "Decision.h"
 #include "Topology.h"
+#include "EnvironmentPlane.h"
+#include "SpeciesCensus.h"
+#include "DecisionCache.h"
+#include "LockstepInterpreter.h"
+#include "BotEvent.h"
+#include "BotIndex.h"
+#include "ThreadPool.h"
+#include "RandomBuffer.h"
+#include "ControlFlow.h"
 
 #include <SFML/Graphics.hpp>
 
 #include <vector>
-#include <random>
-
-class FieldView;
+#include <array>
+#include <memory>
+#include <type_traits>
 
 class Field {
 public:
@@ -33,6 +43,8 @@ public:
         float multiplyCost = 20.0f;
         float startEnergy = 10.0f;
         float instructionCost = 0.1f;
+        // instructions a bot can execute in one epoch, bounds the time of an epoch
+        int instructionBudget = 16384;
         float killGainRatio = 0.5f;
         float eatEfficiency = 0.5f;
         float grassGrowth = 0.05f;
@@ -48,14 +60,49 @@ public:
         float grassDeath = 0.05f;
         float deadGrassOrganicRatio = 0.5f;
         bool preserveEnergy = false;
+        // every transfer moves a quantized amount from one place to another,
+        // parts lost by ratios go to organic, total energy counts everything with weight 1,
+        // exact only with double environment
+        bool fixedPointEnergy = false;
+        // round compact environment stochastically instead of to nearest
+        bool stochasticRounding = false;
+        // store mutants as small patches against their parent species
+        bool deltaGenomes = false;
+        // replay cached random-free segments at the start of decisions instead of interpreting them
+        bool memoizeDecisions = false;
+        // run the random-free start of decisions of a chunk in lockstep before interpreting the rest,
+        // not used while decisions are memoized
+        bool lockstepDecisions = false;
+        // skip chunks without bots whose environment stopped changing
+        bool sleepChunks = true;
+        // sleep only if environment is bit-identical, otherwise if it changed less than epsilon
+        bool exactSleep = true;
+        float sleepEpsilon = 1e-6f;
     };
 
     struct Statistics {
         int population;
         float totalEnergy;
+        int allocatedChunks;
+        int sleepingChunks;
+        int species;
+        // bots that hit the instruction budget in the last epoch
+        int cappedBots;
+        // decisions of the last epoch that replayed a cached segment
+        float decisionCacheHitRate;
+        // bots that made a decision in the last epoch per second of the decision phase
+        float decisionsPerSecond;
+    };
+
+    // neighbours of a bot at the start of the decision phase, bit d is for direction d
+    struct NeighbourMasks {
+        // cell exists and has no bot
+        uint8_t empty = 0;
+        uint8_t occupied = 0;
     };
 
-    Field(int width, int height, uint64_t seed);
+    Field(int width, int height, uint64_t seed, 
+          EnvironmentPlane::Format environmentFormat = EnvironmentPlane::Format::DOUBLE);
 
     int getWidth() const noexcept {
         return m_width;
@@ -73,8 +120,9 @@ public:
         return sf::FloatRect(0.f, 0.f, m_width, m_height);
     }
 
-    std::mt19937_64& getRandomEngine() noexcept {
-        return m_randomEngine;
+    // for the simulation thread only
+    RandomBuffer& getRandomBuffer() noexcept {
+        return m_randomBuffer;
     }
 
     int getEpoch() const noexcept {
@@ -111,97 +159,335 @@ public:
         m_topology = std::move(topology);
     }
 
-    // i is y and j is x
+    EnvironmentPlane::Format getEnvironmentFormat() const noexcept {
+        return m_environmentFormat;
+    }
+
+    // cells are stored in CHUNK_SIZE x CHUNK_SIZE chunks allocated on demand,
+    // chunks without bots and with the same environment in every cell share one environment
+    static constexpr int CHUNK_SIZE = 64;
+    static constexpr int CHUNK_AREA = CHUNK_SIZE * CHUNK_SIZE;
+
     // unsafe, check indices by yourself
+    // allocates the chunk of the cell if it isn't allocated and wakes it up
     Cell& at(int x, int y) noexcept {
-        return m_cells[y * m_width + x];
+        int chunkIndex = getChunkIndex(x, y);
+        Chunk& chunk = m_chunks[chunkIndex];
+        if (!chunk.data) allocateChunk(chunkIndex);
+        chunk.sleeping = false;
+        chunk.changed = true;
+        return chunk.data->cells[getIndexInChunk(x, y)];
     }
 
-    // i is y and j is x
     // unsafe, check indices by yourself
     const Cell& at(int x, int y) const noexcept {
-        return m_cells[y * m_width + x];
+        const Chunk& chunk = m_chunks[getChunkIndex(x, y)];
+        if (!chunk.data) return m_emptyCell;
+        return chunk.data->cells[getIndexInChunk(x, y)];
+    }
+
+    // unsafe, only for cells with bots during the decision phase
+    const NeighbourMasks& getNeighbourMasks(int x, int y) const noexcept {
+        return m_chunks[getChunkIndex(x, y)].data->neighbourMasks[getIndexInChunk(x, y)];
+    }
+
+    // unsafe, check indices by yourself
+    double getGrass(int x, int y) const noexcept {
+        const Chunk& chunk = m_chunks[getChunkIndex(x, y)];
+        if (!chunk.data) return chunk.uniformGrass;
+        return chunk.data->grass.get(getIndexInChunk(x, y));
     }
 
-    // automatically pass position to constructor
-    template<typename... Args>
-    void emplace(int x, int y, Args&&... args) noexcept {
-        at(x, y) = Cell{sf::Vector2f(x, y), std::forward<Args>(args)...};
+    // unsafe, check indices by yourself
+    double getOrganic(int x, int y) const noexcept {
+        const Chunk& chunk = m_chunks[getChunkIndex(x, y)];
+        if (!chunk.data) return chunk.uniformOrganic;
+        return chunk.data->organic.get(getIndexInChunk(x, y));
     }
 
-    using iterator = std::vector<Cell>::iterator;
-    using const_iterator = std::vector<Cell>::const_iterator;
+    // unsafe, check indices by yourself
+    // value is rounded to the environment format, the chunk is allocated and woken up as by at
+    void setGrass(int x, int y, double grass) noexcept;
+    void setOrganic(int x, int y, double organic) noexcept;
 
-    iterator begin() noexcept {
-        return m_cells.begin();
+    // false if all cells of the chunk share the environment of one cell
+    bool isAllocated(int x, int y) const noexcept {
+        return static_cast<bool>(m_chunks[getChunkIndex(x, y)].data);
     }
 
-    const_iterator cbegin() const noexcept {
-        return m_cells.cbegin();
+    // energy of a new bot, in fixed point mode it can't be more than its parent spent
+    double getOffspringEnergy() const noexcept;
+
+    // rounds all energy to the fixed point grid, call before enabling fixedPointEnergy
+    void roundEnergy() noexcept;
+
+    // unsafe, check indices by yourself
+    // edit bots from outside of the simulation, observers get the events at once
+    void placeBot(int x, int y, std::unique_ptr<Bot>&& bot);
+    void deleteBot(int x, int y);
+
+    // position of the bot with the id after the last epoch, {-1, -1} if it's dead
+    sf::Vector2i findBot(uint64_t id) const noexcept {
+        int cell = m_botIndex.find(id);
+        if (cell == BotIndex::NONE) return {-1, -1};
+        return {cell % m_width, cell / m_width};
     }
 
-    const_iterator begin() const noexcept {
-        return cbegin();
+    SpeciesStore& getSpeciesStore() noexcept {
+        return m_speciesStore;
     }
 
-    iterator end() noexcept {
-        return m_cells.end();
+    const SpeciesStore& getSpeciesStore() const noexcept {
+        return m_speciesStore;
     }
 
-    const_iterator cend() const noexcept {
-        return m_cells.cend();
+    const SpeciesCensus& getCensus() const noexcept {
+        return m_census;
     }
 
-    const_iterator end() const noexcept {
-        return cend();
+    DecisionCache& getDecisionCache() noexcept {
+        return m_decisionCache;
     }
 
-    void randomFill(float density) noexcept;
+    void randomFill(float density);
     void clear() noexcept;
 
     void update();
 
-    void setView(FieldView* view) noexcept {
-        m_view = view;
-    }
+    // observers get bot events after every epoch, the census is always notified first
+    void addObserver(BotEventObserver* observer);
+    void removeObserver(BotEventObserver* observer) noexcept;
 private:
+    struct ChunkData {
+        explicit ChunkData(EnvironmentPlane::Format format) noexcept;
+
+        std::array<Cell, CHUNK_AREA> cells;
+        std::array<Decision, CHUNK_AREA> decisions;
+        std::array<NeighbourMasks, CHUNK_AREA> neighbourMasks;
+        EnvironmentPlane grass;
+        EnvironmentPlane organic;
+        // environment from the start of the epoch, then the diffused one
+        EnvironmentPlane newGrass;
+        EnvironmentPlane newOrganic;
+    };
+
+    struct Chunk {
+        std::unique_ptr<ChunkData> data;
+        double uniformGrass = 255.0;
+        double uniformOrganic = 0.0;
+        // chunks containing neighbours of cells from this one
+        std::vector<int> neighbours;
+
+        // sleeping chunks are allocated, have no bots and aren't updated
+        bool sleeping = false;
+        // environment seen by neighbours may differ from the previous epoch
+        bool changed = true;
+        // environment at the end of the epoch differs from its start
+        bool changing = false;
+        // bots in the chunk when decisions were made
+        int population = 0;
+    };
+
     int m_width;
     int m_height;
     std::unique_ptr<Topology> m_topology;
 
-    std::vector<Cell> m_cells;
+    int m_chunksX;
+    int m_chunksY;
+    std::vector<Chunk> m_chunks;
+    // topology the neighbours of chunks were computed for, -1 if not computed
+    int m_chunksTopologyId;
+    std::vector<int> m_activeChunks;
+    std::vector<int> m_unstableChunks;
+    // data of collapsed chunks kept for reuse, chunks collapse and reallocate near bots often
+    std::vector<std::unique_ptr<ChunkData>> m_freeChunkData;
+    static constexpr int MAX_FREE_CHUNK_DATA = 16;
+
+    EnvironmentPlane::Format m_environmentFormat;
+    // returned for cells of chunks that aren't allocated
+    Cell m_emptyCell;
+
     int m_epoch;
 
     Settings m_settings;
 
-    FieldView* m_view;
+    int m_cappedBots;
+    float m_decisionsPerSecond;
+    DecisionCache m_decisionCache;
+    LockstepInterpreter m_lockstepInterpreter;
+
+    // species of the bots of this field only, so fields don't collect each other's species
+    SpeciesStore m_speciesStore;
+    SpeciesCensus m_census;
+
+    // events of the current epoch, cleared once observers got them
+    std::vector<BotEvent> m_events;
+    std::vector<BotEventObserver*> m_observers;
+    BotIndex m_botIndex;
+    uint64_t m_nextBotId;
 
     sf::RectangleShape m_borderShape;
 
-    std::mt19937_64 m_randomEngine;
+    RandomBuffer m_randomBuffer;
+
+    // offspring born during applyDecisions with the species of their parents, 
+    // they mutate afterwards in parallel, ids of births are consecutive from the first one
+    std::vector<SpeciesStore::Mutant> m_offspring;
+    std::vector<sf::Vector2i> m_offspringPositions;
+    uint64_t m_firstOffspringId;
+    ThreadPool m_threadPool;
+
+    // bot of randomFill generated in parallel, placed afterwards in order
+    struct RandomBot {
+        sf::Vector2i position;
+        int rotation;
+        Species species;
+        ControlFlow controlFlow;
+    };
+
+    // rows generated from one random stream by randomFill
+    static constexpr int FILL_BAND_HEIGHT = 8;
+    // bands generated before they are placed, bounds the memory of generated bots
+    static constexpr int FILL_BANDS_PER_THREAD = 4;
+    // generated bots of every band, kept between fills like the buffers of other parallel passes
+    std::vector<std::vector<RandomBot>> m_fillBands;
 
     int computePopulation() const;
     double computeTotalEnergy() const;
+    int countAllocatedChunks() const noexcept;
+    int countSleepingChunks() const noexcept;
 
     int getArea() const {
         return m_width * m_height;
     }
 
-    std::vector<Decision> makeDecisions();
+    int getChunkIndex(int x, int y) const noexcept {
+        return y / CHUNK_SIZE * m_chunksX + x / CHUNK_SIZE;
+    }
 
-    void applyDecisions(std::vector<Decision>&& decisions);
+    // every index into chunk data has to come from here or from forEachStoredCell
+    static int getIndexInChunk(int x, int y) noexcept {
+#ifdef MORTON_CELL_ORDER
+        // bits of x and y interleaved, so cells of the rows above and below are near in memory
+        return spreadBits(x % CHUNK_SIZE) | spreadBits(y % CHUNK_SIZE) << 1;
+#else
+        return y % CHUNK_SIZE * CHUNK_SIZE + x % CHUNK_SIZE;
+#endif
+    }
+
+    // puts a zero bit before every bit of an 8 bit value
+    static constexpr int spreadBits(int value) noexcept {
+        static_assert(CHUNK_SIZE <= 256 && (CHUNK_SIZE & (CHUNK_SIZE - 1)) == 0);
+        value = (value | value << 4) & 0x0f0f;
+        value = (value | value << 2) & 0x3333;
+        return (value | value << 1) & 0x5555;
+    }
 
-    void applyDecisions(const std::vector<Decision>& decisions_) {
-        auto decisions = decisions_;
-        applyDecisions(std::move(decisions));
+    // keeps every other bit, the inverse of spreadBits
+    static constexpr int compactBits(int value) noexcept {
+        value &= 0x5555;
+        value = (value | value >> 1) & 0x3333;
+        value = (value | value >> 2) & 0x0f0f;
+        return (value | value >> 4) & 0x00ff;
     }
 
+    // calls visit(x, y, index) for the cells of the chunk rect in the order they are stored,
+    // only for passes where cells don't depend on each other, decisions stay row by row;
+    // a visit returning bool stops the walk by returning false
+    template <typename Visit>
+    static void forEachStoredCell(sf::IntRect rect, Visit&& visit) {
+        auto call = [&visit] (int x, int y, int index) {
+            if constexpr (std::is_same_v<decltype(visit(x, y, index)), bool>) {
+                return visit(x, y, index);
+            } else {
+                visit(x, y, index);
+                return true;
+            }
+        };
+#ifdef MORTON_CELL_ORDER
+        // chunks start at multiples of CHUNK_SIZE, cells of edge chunks outside the field are skipped
+        for (int index = 0; index < CHUNK_AREA; ++ index) {
+            int x = rect.left + compactBits(index), y = rect.top + compactBits(index >> 1);
+            if (x >= rect.left + rect.width || y >= rect.top + rect.height) continue;
+            if (!call(x, y, index)) return;
+        }
+#else
+        for (int y = rect.top; y < rect.top + rect.height; ++ y)
+            for (int x = rect.left; x < rect.left + rect.width; ++ x)
+                if (!call(x, y, getIndexInChunk(x, y))) return;
+#endif
+    }
+
+    // part of the field covered by the chunk
+    sf::IntRect getChunkRect(int chunkIndex) const noexcept;
+
+    void allocateChunk(int chunkIndex) noexcept;
+    // builds neighbour masks of all bots in the chunk
+    void senseNeighbours(int chunkIndex) noexcept;
+    void updateChunkNeighbours();
+    // true if uniform chunk can't be changed by diffusion
+    bool isStable(int chunkIndex) const noexcept;
+    // free chunks without bots where every cell has the same environment
+    void collapseChunks() noexcept;
+    void updateSleeping() noexcept;
+    void wakeUpAll() noexcept;
+
+    // compares environment before and after an update according to sleep settings
+    bool hasChanged(double before, double after) const noexcept;
+
+    // grass and organic are kept in [0, 255] unless energy is fixed point
+    double clampEnvironment(double value) const noexcept;
+
+    // every rounding of the same value during an epoch gets its own noise
+    enum class RoundingStage {
+        DECISIONS = 0,
+        KILL,
+        OFFSPRING,
+        GROWTH,
+        DIFFUSION,
+        ENERGY_FIX,
+        EXTERNAL
+    };
+
+    uint32_t getRoundingNoise(int chunkIndex, int index, 
+                              RoundingStage stage, bool organic) const noexcept;
+    // chunk should be allocated
+    void storeGrass(int chunkIndex, int index, double grass, RoundingStage stage) noexcept;
+    void storeOrganic(int chunkIndex, int index, double organic, RoundingStage stage) noexcept;
+    void storeUniform(int chunkIndex, double grass, double organic, RoundingStage stage) noexcept;
+
+    void makeDecisions();
+    // decisions of bots in a chunk through the LockstepInterpreter
+    void makeLockstepDecisions(int chunkIndex) noexcept;
+    void applyDecisions();
+
+    void updateGrass(double& grass, double& organic) const noexcept;
+    void updateGrassFixedPoint(double& grass, double& organic) const noexcept;
+    void updateGrass(int chunkIndex) noexcept;
     void updateGrass();
     void diffuseGrass();
 
     void fixEnergy(double shouldBe);
 
-    void notifyDied();
+    // mutates offspring of the epoch and gives them and their events the new species
+    void mutateOffspring();
+
+    // bots that died, were killed or moved away during the epoch
+    void removeDead() noexcept;
+
+    void addEvent(BotEvent::Type type, sf::Vector2i position, sf::Vector2i source, const Bot& bot, 
+                  DeathCause death = DeathCause::NONE, uint64_t parentId = 0) {
+        m_events.push_back({type, death, position, source, bot.getSpecies(), bot.getId(), 
+                            parentId, static_cast<float>(bot.getEnergy())});
+    }
+
+    void placeBotSilently(int x, int y, std::unique_ptr<Bot>&& bot);
+    void dispatchEvents();
+    void updateBotIndex();
+
+    // species without bots are freed once in this number of epochs
+    static constexpr int SPECIES_COLLECTION_PERIOD = 16;
+    void collectSpecies() noexcept;
 };
 
 #endif
\ No newline at end of file
@@ -14,6 +14,7 @@ If not, see <https://www.gnu.org/licenses/>. */
 #include "FieldView.h"
 #include "utility.h"
 #include "Topology.h"
+#include "AllocationCounter.h"
 
 #include <imgui.h>
 #include <imgui-SFML.h>
@@ -29,9 +30,18 @@ using ImGui::PlotLines;
 using ImGui::BeginDisabled;
 using ImGui::EndDisabled;
 using ImGui::Combo;
+using ImGui::BeginTable;
+using ImGui::EndTable;
+using ImGui::TableSetupColumn;
+using ImGui::TableHeadersRow;
+using ImGui::TableNextRow;
+using ImGui::TableNextColumn;
+using ImGui::TableGetSortSpecs;
+using ImGui::ColorButton;
 
 #include <SFML/Graphics.hpp>
 using sf::FloatRect;
+using sf::IntRect;
 using sf::Vector2f;
 using sf::Vector2i;
 using sf::Color;
@@ -63,6 +73,9 @@ using std::array;
 #include <deque>
 using std::deque;
 
+#include <vector>
+using std::vector;
+
 #include <string>
 using std::string;
 
@@ -72,6 +85,9 @@ using std::ssize;
 using std::make_unique;
 using std::unique_ptr;
 
+#include <utility>
+using std::as_const;
+
 #include <algorithm>
 using std::max;
 using std::min;
@@ -81,19 +97,89 @@ using std::pow;
 using std::fmod;
 using std::fmodf;
 using std::floor;
+using std::ceil;
+
+#include <cstdlib>
+using std::abs;
+
+#include <span>
+using std::span;
 
 const int STATISTICS_HISTORY_SIZE = 128;
 
+const int MIP_TILE_SIZE = 32;
+const int MINIMAP_RESOLUTION = 128;
+// bigger fields are sampled into the first overview level and drawn without shaders
+const int MAX_OVERVIEW_SIZE = 4096;
+const float MINIMAP_SIZE = 192.f;
+const float MINIMAP_MARGIN = 16.f;
+
+// mirrors getCellColor, getBotColor and overview colors of FieldView,
+// modes are numbered as in FieldView::Mode
+const char* VIEW_SHADER_SOURCE = R"(
+uniform sampler2D environment;
+uniform sampler2D bots;
+uniform sampler2D species;
+uniform vec2 fieldSize;
+uniform int mode;
+uniform bool details;
+uniform vec2 selected;
+
+void main() {
+    vec2 position = gl_TexCoord[0].xy * fieldSize;
+    vec2 cell = floor(position);
+    vec2 inCell = position - cell;
+
+    // grass in red and organic in green, shown as organic red and grass green
+    vec2 cellEnvironment = texture2D(environment, gl_TexCoord[0].xy).rg;
+    vec4 cellColor = vec4(cellEnvironment.g, cellEnvironment.r, 0.0, 1.0);
+    vec4 speciesColor = texture2D(species, gl_TexCoord[0].xy);
+    if (mode == 0 || speciesColor.a < 0.5) {
+        gl_FragColor = cellColor;
+        return;
+    }
+
+    vec4 bot = texture2D(bots, gl_TexCoord[0].xy);
+    vec4 botColor;
+    if (mode == 2) {
+        botColor = vec4(bot.rg, 0.0, 1.0);
+    } else if (mode == 3) {
+        botColor = vec4(bot.bbb, 1.0);
+    } else if (mode == 4) {
+        botColor = vec4(bot.aaa, 1.0);
+    } else {
+        botColor = vec4(speciesColor.rgb, 1.0);
+    }
+
+    if (details) {
+        bool inBot = all(greaterThanEqual(inCell, vec2(0.1))) 
+                  && all(lessThanEqual(inCell, vec2(0.9)));
+        gl_FragColor = inBot ? botColor : cellColor;
+    } else if (cell == selected) {
+        gl_FragColor = vec4(1.0, 0.0, 0.0, 1.0);
+    } else {
+        gl_FragColor = botColor;
+    }
+}
+)";
+
 FieldView::FieldView(Vector2f screenSize, uint64_t seed) : 
         m_field{nullptr}, m_fieldWidth{128}, m_fieldHeight{128}, 
-        m_fieldTopology{nullptr},
-        m_randomEngine{seed}, m_cellsVertices{Triangles}, m_botsVertices{Triangles}, m_view{},
+        m_fieldTopology{nullptr}, m_fieldEnvironmentFormat{EnvironmentPlane::Format::DOUBLE},
+        m_randomEngine{seed}, m_cellsVertices{Triangles}, m_botsVertices{Triangles}, 
+        m_directionsVertices{Triangles}, m_view{},
         m_screenSize{screenSize}, m_zoom{1.0f}, m_shouldDrawBots{true}, 
         m_fillDensity{0.5f}, m_simulationSpeed{1.f}, m_simulationStepRest{0.f}, m_paused{true}, 
-        m_tool{Tool::SELECT_BOT}, m_selectedBot{-1, -1}, m_selectionShape{{0.f, 0.f}},
+        m_tool{Tool::SELECT_BOT}, m_selectedBot{-1, -1}, 
+        m_selectedBotId{BotIndex::NO_ID}, m_followSelectedBot{false}, m_selectionShape{{0.f, 0.f}},
         m_mode{Mode::BOTS},
-        m_recentFiles{}, m_selectedFile{-1}, m_loadedBot{nullptr}, 
-        m_statistics(STATISTICS_HISTORY_SIZE),
+        m_recentFiles{}, m_selectedFile{-1}, m_loadedBot{nullptr}, m_lineageLog{nullptr}, 
+        m_statistics(STATISTICS_HISTORY_SIZE), m_updateAllocations{0},
+        m_censusSize{16}, m_censusRecords{}, 
+        m_mipLevels{}, m_overviewScale{1}, m_mipUploadBuffer{}, m_overviewMode{OverviewMode::AVERAGE}, m_fieldTexture{},
+        m_useShaders{false}, m_viewShader{}, m_environmentData{}, m_botsData{}, m_speciesData{}, 
+        m_environmentTexture{}, m_botsTexture{}, m_speciesTexture{}, m_overviewTexture{},
+        m_fieldDataDirty{true}, m_overviewDirty{true},
         m_baseZoomingChange{1.1f}, m_baseMovingSpeed{10.f}, m_speedModificator{10.f} {
     m_selectionShape.setFillColor(Color::Transparent);
     m_selectionShape.setOutlineColor(Color::Red);
@@ -101,6 +187,9 @@ FieldView::FieldView(Vector2f screenSize, uint64_t seed) :
     m_selectionShape.setOrigin(0.25, 0.25);
 
     resize(screenSize.x, screenSize.y);
+
+    if (sf::Shader::isAvailable())
+        m_viewShader.loadFromMemory(VIEW_SHADER_SOURCE, sf::Shader::Fragment);
 }
 
 bool FieldView::handleMouseWheelScrollEvent(const Event::MouseWheelScrollEvent& event) noexcept {
@@ -124,6 +213,15 @@ bool FieldView::handleMouseButtonPressedEvent(const Event::MouseButtonEvent& eve
                                               const RenderTarget& target) noexcept {
     if (!m_field) return false;
 
+    Vector2f screenPos = target.mapPixelToCoords({event.x, event.y});
+    FloatRect minimapRect = getMinimapRect(target.getView().getSize());
+    if (minimapRect.contains(screenPos)) {
+        Vector2f relativePos{screenPos.x - minimapRect.left, screenPos.y - minimapRect.top};
+        m_view.setCenter(relativePos.x / minimapRect.width * m_field->getWidth(), 
+                         relativePos.y / minimapRect.height * m_field->getHeight());
+        return true;
+    }
+
     if (!m_view.getViewport().contains(static_cast<float>(event.x) / target.getSize().x, 
             static_cast<float>(event.y) / target.getSize().y)) {
         if (m_tool == Tool::SELECT_BOT) {
@@ -139,29 +237,34 @@ bool FieldView::handleMouseButtonPressedEvent(const Event::MouseButtonEvent& eve
 
     switch (m_tool) {
         case Tool::SELECT_BOT:
-            if (!m_field->at(pos.x, pos.y).hasBot()) {
+            if (!as_const(*m_field).at(pos.x, pos.y).hasBot()) {
                 selectBot({-1, -1});
             } else selectBot(Vector2i(pos.x, pos.y));
             return true;
         case Tool::DELETE_BOT:
-            m_field->at(pos.x, pos.y).deleteBot();
+            m_field->deleteBot(pos.x, pos.y);
+            m_fieldDataDirty = true;
             return true;
         case Tool::PLACE_BOT:
             if (!m_loadedBot) {
                 if (m_selectedFile == -1) {
-                    m_field->at(pos.x, pos.y).setBot(
-                        make_unique<Bot>(Bot::createRandom(pos, m_field->getRandomEngine())));
+                    m_field->placeBot(pos.x, pos.y, 
+                        make_unique<Bot>(Bot::createRandom(pos, m_field->getSpeciesStore(), 
+                                                           m_field->getRandomBuffer())));
+                    m_fieldDataDirty = true;
                     return true;
                 }
 
                 ifstream file{m_recentFiles[m_selectedFile].second};
 
                 m_loadedBot = make_unique<Bot>();
-                file >> *m_loadedBot;
+                m_loadedBot->read(file, m_field->getSpeciesStore());
+                m_field->getSpeciesStore().pin(m_loadedBot->getSpecies());
             }
 
-            m_field->at(pos.x, pos.y).setBot(make_unique<Bot>(*m_loadedBot));
+            m_field->placeBot(pos.x, pos.y, make_unique<Bot>(*m_loadedBot));
             m_field->at(pos.x, pos.y).getBot().setEnergy(10.0);
+            m_fieldDataDirty = true;
             return true;
     }
 
@@ -173,7 +276,10 @@ void FieldView::updateField() noexcept {
 
     m_simulationStepRest += getSimulationSpeed();
     while (m_simulationStepRest >= 1.f) {
+        AllocationCounter allocations;
         m_field->update();
+        m_updateAllocations = allocations.getCount();
+        m_fieldDataDirty = true;
 
         m_statistics.pop_front();
         m_statistics.push_back(m_field->computeStatistics());
@@ -201,7 +307,7 @@ Color FieldView::getBotColor(const Cell& cell) const noexcept {
             return Color(brightness, brightness, brightness);
         }
         default:
-            return cell.getBot().getColor();
+            return cell.getBot().getColor(m_field->getSpeciesStore());
             break;
         }
     } else return Color::Transparent;
@@ -225,57 +331,569 @@ void FieldView::update(bool keyboardAvailable, Time elapsedTime) noexcept {
             m_view.setCenter(m_view.getCenter().x + moved, m_view.getCenter().y); 
     }
 
-    for (int x = 0; x < m_field->getWidth(); ++ x)
-        for (int y = 0; y < m_field->getHeight(); ++ y) {
-            int offset = y * m_field->getWidth() * 6 + x * 6;
-            for (int i = 0; i < 6; ++ i) {
-                if (0.25f * getScreenToViewRatio() >= 1.f || m_mode == Mode::LANDSCAPE) {
-                    m_cellsVertices[offset + i].color = getCellColor(m_field->at(x, y));
-                    m_botsVertices[offset + i].color = getBotColor(m_field->at(x, y));
-                } else {
-                    if (m_field->at(x, y).hasBot()) {
-                        if (m_selectedBot == Vector2i{x, y}) {
-                            m_cellsVertices[offset + i].color = Color::Red;
-                        } else {
-                            m_cellsVertices[offset + i].color 
-                                = getBotColor(m_field->at(x, y));
-                        }
-                    } else {
-                        m_cellsVertices[offset + i].color = getCellColor(m_field->at(x, y));
-                    }
+    // data only changes with the field, modes are applied by the shader
+    if (m_useShaders && m_fieldDataDirty) {
+        updateDataTextures();
+        m_fieldDataDirty = false;
+        m_overviewDirty = true;
+    }
+
+    bool details = shouldDrawDetails();
+    bool cpuOverview = !hasShaderOverview();
+    bool cpuDetails = details && !m_useShaders;
+    if (!cpuOverview && !cpuDetails) {
+        if (details) updateDirectionsVertices();
+        return;
+    }
+
+    if (cpuOverview) {
+        const MipLevel& level = m_mipLevels[0];
+        for (int y = 0; y < level.height; ++ y)
+            for (int x = 0; x < level.width; ++ x) {
+                setOverviewColor(x, y, getOverviewColor(x * m_overviewScale, y * m_overviewScale));
+        }
+    }
+
+    if (cpuDetails) updateCellsVertices();
+    if (details) updateDirectionsVertices();
+    if (cpuOverview) updateMipLevels();
+}
+
+bool FieldView::canUseShaders() const noexcept {
+    int side = max(m_field->getWidth(), m_field->getHeight());
+    return m_viewShader.getNativeHandle() != 0 && side <= MAX_OVERVIEW_SIZE
+        && static_cast<unsigned int>(side) <= sf::Texture::getMaximumSize();
+}
+
+void FieldView::createDataTextures() noexcept {
+    m_useShaders = canUseShaders();
+    if (!m_useShaders) return;
+
+    int area = m_field->getWidth() * m_field->getHeight();
+    m_environmentData.assign(area, Color::Black);
+    m_botsData.assign(area, Color::Black);
+    m_speciesData.assign(area, Color::Transparent);
+    m_fieldDataDirty = true;
+
+    m_useShaders = m_environmentTexture.create(m_field->getWidth(), m_field->getHeight())
+                && m_botsTexture.create(m_field->getWidth(), m_field->getHeight())
+                && m_speciesTexture.create(m_field->getWidth(), m_field->getHeight())
+                && m_overviewTexture.create(m_field->getWidth(), m_field->getHeight());
+    m_overviewTexture.setSmooth(true);
+}
+
+void FieldView::updateDataTextures() noexcept {
+    int lifetime = max(m_field->getSettings().lifetime, 1);
+    for (int y = 0; y < m_field->getHeight(); ++ y)
+        for (int x = 0; x < m_field->getWidth(); ++ x) {
+            const Cell& cell = as_const(*m_field).at(x, y);
+            int index = y * m_field->getWidth() + x;
+
+            // raw values, as much of them as fits into a byte
+            Color& environmentData = m_environmentData[index];
+            environmentData.r = clamp(m_field->getGrass(x, y), 0.0, 255.0);
+            environmentData.g = clamp(m_field->getOrganic(x, y), 0.0, 255.0);
+
+            if (!cell.hasBot()) {
+                m_speciesData[index] = Color::Transparent;
+                continue;
+            }
+
+            const Bot& bot = cell.getBot();
+            Color& botData = m_botsData[index];
+            if (bot.getAge() == 0) {
+                botData.r = botData.g = 0;
+            } else {
+                botData.r = min(static_cast<double>(bot.getKills()) / bot.getAge(), 1.) * 255;
+                botData.g = min(static_cast<double>(bot.getEats()) / bot.getAge(), 1.) * 255;
+            }
+            botData.b = clamp(bot.getAge() * 255 / lifetime, 0, 255);
+            botData.a = clamp(bot.getEnergy(), 0.0, 255.0);
+
+            m_speciesData[index] = bot.getColor(m_field->getSpeciesStore());
+            m_speciesData[index].a = 255;
+    }
+
+    m_environmentTexture.update(reinterpret_cast<const Uint8*>(m_environmentData.data()));
+    m_botsTexture.update(reinterpret_cast<const Uint8*>(m_botsData.data()));
+    m_speciesTexture.update(reinterpret_cast<const Uint8*>(m_speciesData.data()));
+}
+
+void FieldView::updateCellsVertices() noexcept {
+    m_cellsVertices.clear();
+    m_botsVertices.clear();
+
+    IntRect visibleCells = getVisibleCellsRect();
+    for (int y = visibleCells.top; y < visibleCells.top + visibleCells.height; ++ y)
+        for (int x = visibleCells.left; x < visibleCells.left + visibleCells.width; ++ x) {
+            const Cell& cell = as_const(*m_field).at(x, y);
+
+            Color cellColor = getCellColor(x, y);
+            m_cellsVertices.append(sf::Vertex{Vector2f(x, y), cellColor});
+            m_cellsVertices.append(sf::Vertex{Vector2f(x + 1, y), cellColor});
+            m_cellsVertices.append(sf::Vertex{Vector2f(x, y + 1), cellColor});
+            m_cellsVertices.append(sf::Vertex{Vector2f(x + 1, y + 1), cellColor});
+            m_cellsVertices.append(sf::Vertex{Vector2f(x + 1, y), cellColor});
+            m_cellsVertices.append(sf::Vertex{Vector2f(x, y + 1), cellColor});
+
+            Color botColor = getBotColor(cell);
+            m_botsVertices.append(sf::Vertex{Vector2f(x + 0.1f, y + 0.1f), botColor});
+            m_botsVertices.append(sf::Vertex{Vector2f(x + 0.9f, y + 0.1f), botColor});
+            m_botsVertices.append(sf::Vertex{Vector2f(x + 0.1f, y + 0.9f), botColor});
+            m_botsVertices.append(sf::Vertex{Vector2f(x + 0.9f, y + 0.9f), botColor});
+            m_botsVertices.append(sf::Vertex{Vector2f(x + 0.9f, y + 0.1f), botColor});
+            m_botsVertices.append(sf::Vertex{Vector2f(x + 0.1f, y + 0.9f), botColor});
+    }
+}
+
+void FieldView::updateDirectionsVertices() noexcept {
+    // direction arrow is a 0.1 x 0.3 rect pointing from the cell center
+    static const array<array<Vector2f, 6>, 8> directionShapes = [] {
+        array<Vector2f, 6> shape{Vector2f{-0.05f, -0.05f}, Vector2f{0.05f, -0.05f}, 
+                                 Vector2f{-0.05f, 0.25f}, Vector2f{0.05f, 0.25f}, 
+                                 Vector2f{0.05f, -0.05f}, Vector2f{-0.05f, 0.25f}};
+
+        array<array<Vector2f, 6>, 8> shapes;
+        for (int rotation = 0; rotation < 8; ++ rotation) {
+            Transform transform = Transform{}.translate(0.5f, 0.5f).rotate(-rotation * 45.f);
+            for (int i = 0; i < 6; ++ i)
+                shapes[rotation][i] = transform.transformPoint(shape[i]);
+        }
+        return shapes;
+    }();
+
+    m_directionsVertices.clear();
+
+    IntRect visibleCells = getVisibleCellsRect();
+    for (int y = visibleCells.top; y < visibleCells.top + visibleCells.height; ++ y)
+        for (int x = visibleCells.left; x < visibleCells.left + visibleCells.width; ++ x) {
+            const Cell& cell = as_const(*m_field).at(x, y);
+            if (!cell.hasBot()) continue;
+
+            for (Vector2f point : directionShapes[cell.getBot().getRotation()])
+                m_directionsVertices.append(sf::Vertex{{x + point.x, y + point.y}, Color::White});
+    }
+}
+
+void FieldView::createMipLevels() noexcept {
+    m_mipLevels.clear();
+
+    m_overviewScale = 1;
+    while (max(m_field->getWidth(), m_field->getHeight()) > MAX_OVERVIEW_SIZE * m_overviewScale)
+        m_overviewScale *= 2;
+
+    int width = (m_field->getWidth() + m_overviewScale - 1) / m_overviewScale;
+    int height = (m_field->getHeight() + m_overviewScale - 1) / m_overviewScale;
+
+    int levelsCount = 1;
+    for (int side = max(width, height); side > 1; side = (side + 1) / 2)
+        ++ levelsCount;
+    m_mipLevels.resize(levelsCount);
+
+    for (MipLevel& level : m_mipLevels) {
+        level.width = width;
+        level.height = height;
+        level.colors.assign(width * height, Color::Transparent);
+
+        level.tilesX = (width + MIP_TILE_SIZE - 1) / MIP_TILE_SIZE;
+        level.tilesY = (height + MIP_TILE_SIZE - 1) / MIP_TILE_SIZE;
+        level.dirtyTiles.assign(level.tilesX * level.tilesY, true);
+
+        level.texture.create(width, height);
+
+        width = (width + 1) / 2;
+        height = (height + 1) / 2;
+    }
+}
+
+void FieldView::setOverviewColor(int x, int y, Color color) noexcept {
+    MipLevel& level = m_mipLevels[0];
+    Color& texel = level.colors[y * level.width + x];
+    if (texel == color) return;
+
+    texel = color;
+    level.dirtyTiles[y / MIP_TILE_SIZE * level.tilesX + x / MIP_TILE_SIZE] = true;
+}
+
+void FieldView::markAllMipTilesDirty() noexcept {
+    std::fill(m_mipLevels[0].dirtyTiles.begin(), m_mipLevels[0].dirtyTiles.end(), true);
+}
+
+Color FieldView::computeMipColor(const MipLevel& previous, int x, int y) const noexcept {
+    array<Color, 4> children;
+    int childrenCount = 0;
+    for (int dy = 0; dy < 2; ++ dy)
+        for (int dx = 0; dx < 2; ++ dx) {
+            int childX = 2 * x + dx, childY = 2 * y + dy;
+            if (childX < previous.width && childY < previous.height)
+                children[childrenCount ++] = previous.colors[childY * previous.width + childX];
+    }
+
+    if (m_overviewMode == OverviewMode::DOMINANT) {
+        // dominant of dominants, exact for 2x2 blocks and close enough above
+        int bestIndex = 0;
+        int bestCount = 0;
+        for (int i = 0; i < childrenCount; ++ i) {
+            int count = 0;
+            for (int j = 0; j < childrenCount; ++ j)
+                if (children[j] == children[i]) ++ count;
+
+            if (count > bestCount) {
+                bestIndex = i;
+                bestCount = count;
+            }
+        }
+        return children[bestIndex];
+    }
+
+    int r = 0, g = 0, b = 0, a = 0;
+    for (int i = 0; i < childrenCount; ++ i) {
+        r += children[i].r;
+        g += children[i].g;
+        b += children[i].b;
+        a += children[i].a;
+    }
+    return Color(r / childrenCount, g / childrenCount, b / childrenCount, a / childrenCount);
+}
+
+void FieldView::updateMipLevels() noexcept {
+    for (int i = 0; i < ssize(m_mipLevels); ++ i) {
+        MipLevel& level = m_mipLevels[i];
+        MipLevel* next = i + 1 < ssize(m_mipLevels) ? &m_mipLevels[i + 1] : nullptr;
+
+        int dirtyCount = 0;
+        for (int tileY = 0; tileY < level.tilesY; ++ tileY)
+            for (int tileX = 0; tileX < level.tilesX; ++ tileX) {
+                if (!level.dirtyTiles[tileY * level.tilesX + tileX]) continue;
+                ++ dirtyCount;
+
+                if (i > 0) {
+                    int xEnd = min((tileX + 1) * MIP_TILE_SIZE, level.width);
+                    int yEnd = min((tileY + 1) * MIP_TILE_SIZE, level.height);
+                    for (int y = tileY * MIP_TILE_SIZE; y < yEnd; ++ y)
+                        for (int x = tileX * MIP_TILE_SIZE; x < xEnd; ++ x)
+                            level.colors[y * level.width + x] 
+                                = computeMipColor(m_mipLevels[i - 1], x, y);
                 }
+
+                if (next) next->dirtyTiles[tileY / 2 * next->tilesX + tileX / 2] = true;
+        }
+
+        if (dirtyCount == 0) break;
+
+        if (2 * dirtyCount > ssize(level.dirtyTiles)) {
+            level.texture.update(reinterpret_cast<const Uint8*>(level.colors.data()));
+        } else {
+            for (int tileY = 0; tileY < level.tilesY; ++ tileY)
+                for (int tileX = 0; tileX < level.tilesX; ++ tileX) {
+                    if (!level.dirtyTiles[tileY * level.tilesX + tileX]) continue;
+
+                    int xStart = tileX * MIP_TILE_SIZE, yStart = tileY * MIP_TILE_SIZE;
+                    int width = min(MIP_TILE_SIZE, level.width - xStart);
+                    int height = min(MIP_TILE_SIZE, level.height - yStart);
+
+                    m_mipUploadBuffer.clear();
+                    for (int y = yStart; y < yStart + height; ++ y)
+                        m_mipUploadBuffer.insert(m_mipUploadBuffer.end(), 
+                            level.colors.begin() + y * level.width + xStart, 
+                            level.colors.begin() + y * level.width + xStart + width);
+                    level.texture.update(reinterpret_cast<const Uint8*>(m_mipUploadBuffer.data()), 
+                                         width, height, xStart, yStart);
             }
+        }
+
+        std::fill(level.dirtyTiles.begin(), level.dirtyTiles.end(), false);
     }
 }
 
+int FieldView::getOverviewLevel() const noexcept {
+    float cellsPerPixel = 1.f / getScreenToViewRatio() / m_overviewScale;
+
+    int level = 0;
+    while (level + 1 < ssize(m_mipLevels) && (2 << level) <= cellsPerPixel) ++ level;
+    return level;
+}
+
+int FieldView::getMinimapLevel() const noexcept {
+    int level = 0;
+    while (level + 1 < ssize(m_mipLevels) 
+           && max(m_mipLevels[level].width, m_mipLevels[level].height) > MINIMAP_RESOLUTION) 
+        ++ level;
+    return level;
+}
+
+FloatRect FieldView::getMinimapRect(Vector2f screenViewSize) const noexcept {
+    float side = max(m_field->getWidth(), m_field->getHeight());
+    Vector2f size{MINIMAP_SIZE * m_field->getWidth() / side, 
+                  MINIMAP_SIZE * m_field->getHeight() / side};
+
+    FloatRect viewport = m_view.getViewport();
+    return FloatRect{screenViewSize.x * (viewport.left + viewport.width) - size.x - MINIMAP_MARGIN, 
+                     screenViewSize.y * (viewport.top + viewport.height) - size.y - MINIMAP_MARGIN,
+                     size.x, size.y};
+}
+
+void FieldView::drawMipLevel(RenderTarget& target, RenderStates states, 
+                             int level, Vector2f position, Vector2f size) const noexcept {
+    const MipLevel& mipLevel = m_mipLevels[level];
+    // cells of the last texel in a row may be absent, so texture coords aren't always full
+    Vector2f textureSize = m_field->getSize() / static_cast<float>(m_overviewScale << level);
+
+    array<sf::Vertex, 4> quad{
+        sf::Vertex{position, {0.f, 0.f}},
+        sf::Vertex{{position.x + size.x, position.y}, {textureSize.x, 0.f}},
+        sf::Vertex{position + size, textureSize},
+        sf::Vertex{{position.x, position.y + size.y}, {0.f, textureSize.y}}};
+
+    states.texture = &mipLevel.texture;
+    target.draw(quad.data(), quad.size(), sf::Quads, states);
+}
+
+void FieldView::drawMinimap(RenderTarget& target, RenderStates states) const noexcept {
+    FloatRect rect = getMinimapRect(target.getView().getSize());
+    Vector2f position{rect.left, rect.top};
+    Vector2f size{rect.width, rect.height};
+    if (hasShaderOverview()) {
+        array<sf::Vertex, 4> quad{
+            sf::Vertex{position, {0.f, 0.f}},
+            sf::Vertex{{position.x + size.x, position.y}, {m_field->getSize().x, 0.f}},
+            sf::Vertex{position + size, m_field->getSize()},
+            sf::Vertex{{position.x, position.y + size.y}, {0.f, m_field->getSize().y}}};
+
+        RenderStates minimapStates = states;
+        minimapStates.texture = &m_overviewTexture.getTexture();
+        target.draw(quad.data(), quad.size(), sf::Quads, minimapStates);
+    } else {
+        drawMipLevel(target, states, getMinimapLevel(), position, size);
+    }
+
+    RectangleShape borderShape{size};
+    borderShape.setPosition(position);
+    borderShape.setFillColor(Color::Transparent);
+    borderShape.setOutlineColor(Color::Black);
+    borderShape.setOutlineThickness(2.f);
+    target.draw(borderShape, states);
+
+    Vector2f scale{rect.width / m_field->getWidth(), rect.height / m_field->getHeight()};
+    Vector2f center{fmod(m_view.getCenter().x, m_field->getSize().x),
+                    fmod(m_view.getCenter().y, m_field->getSize().y)};
+    if (center.x < 0.f) center.x += m_field->getSize().x;
+    if (center.y < 0.f) center.y += m_field->getSize().y;
+
+    RectangleShape viewShape{{m_view.getSize().x * scale.x, m_view.getSize().y * scale.y}};
+    viewShape.setOrigin(viewShape.getSize() / 2.f);
+    viewShape.setPosition(rect.left + center.x * scale.x, rect.top + center.y * scale.y);
+    viewShape.setFillColor(Color::Transparent);
+    viewShape.setOutlineColor(Color::Red);
+    viewShape.setOutlineThickness(1.f);
+    target.draw(viewShape, states);
+}
+
 void FieldView::drawField(RenderTarget& target, RenderStates states) const noexcept {
-    target.draw(m_cellsVertices, states);
-    if (0.25f * getScreenToViewRatio() >= 1.f && m_mode != Mode::LANDSCAPE) {
+    if (m_useShaders) {
+        drawFieldData(target, states, true);
+    } else {
+        target.draw(m_cellsVertices, states);
         target.draw(m_botsVertices, states);
+    }
+    target.draw(m_directionsVertices, states);
 
-        for (Cell& cell : *m_field) 
-            if (cell.hasBot()) cell.getBot().drawDirection(target, states);
+    if (m_selectedBot != Vector2i(-1, -1)) 
+        target.draw(m_selectionShape, states);
+}
+
+vector<Transform> FieldView::getVisibleTileTransforms() const noexcept {
+    Vector2f fieldSize = m_field->getSize();
 
-        if (m_selectedBot != Vector2i(-1, -1)) 
-            target.draw(m_selectionShape, states);
+    // copies of the field inside one period of the topology
+    vector<Transform> baseTransforms;
+    Vector2f period{0.f, 0.f};
+    switch (m_field->getTopology().getId()) {
+    case Topology::Id::TORUS:
+        baseTransforms.push_back(Transform::Identity);
+        period = fieldSize;
+        break;
+    case Topology::Id::CYLINDER_X:
+        baseTransforms.push_back(Transform::Identity);
+        period.x = fieldSize.x;
+        break;
+    case Topology::Id::CYLINDER_Y:
+        baseTransforms.push_back(Transform::Identity);
+        period.y = fieldSize.y;
+        break;
+    case Topology::Id::PLANE:
+        baseTransforms.push_back(Transform::Identity);
+        break;
+    case Topology::Id::SPHERE_LEFT:
+        for (float rotation = 0.f; rotation < 360.f; rotation += 90.f)
+            baseTransforms.push_back(Transform{}.rotate(rotation, fieldSize));
+        period = 2.f * fieldSize;
+        break;
+    case Topology::Id::SPHERE_RIGHT:
+        baseTransforms.push_back(Transform::Identity);
+        baseTransforms.push_back(Transform{}.rotate(-90.f, fieldSize.x, 0.f));
+        baseTransforms.push_back(Transform{}.rotate(180.f, fieldSize));
+        baseTransforms.push_back(Transform{}.rotate(90.f, 0.f, fieldSize.y));
+        period = 2.f * fieldSize;
+        break;
+    case Topology::Id::CONE_LEFT_TOP:
+    case Topology::Id::CONE_RIGHT_TOP:
+    case Topology::Id::CONE_LEFT_BOTTOM:
+    case Topology::Id::CONE_RIGHT_BOTTOM:
+        for (float rotation = 0.f; rotation < 360.f; rotation += 90.f)
+            baseTransforms.push_back(Transform{}.rotate(rotation, getConeApex()));
+        break;
+    }
+
+    Vector2f viewStart = m_view.getCenter() - m_view.getSize() / 2.f;
+    Vector2f viewEnd   = m_view.getCenter() + m_view.getSize() / 2.f;
+    FloatRect viewRect{viewStart, m_view.getSize()};
+
+    Vector2f renderStart{0.f, 0.f};
+    Vector2f renderEnd{1.f, 1.f};
+    if (period.x > 0.f) {
+        renderStart.x = getFirstInInterval(0.f, period.x, viewStart.x, viewEnd.x);
+        renderEnd.x = viewEnd.x;
     }
+    if (period.y > 0.f) {
+        renderStart.y = getFirstInInterval(0.f, period.y, viewStart.y, viewEnd.y);
+        renderEnd.y = viewEnd.y;
+    }
+
+    vector<Transform> transforms;
+    for (float y = renderStart.y; y < renderEnd.y; y += max(period.y, 1.f))
+        for (float x = renderStart.x; x < renderEnd.x; x += max(period.x, 1.f))
+            for (const Transform& baseTransform : baseTransforms) {
+                Transform transform = Transform{}.translate(x, y) * baseTransform;
+                if (transform.transformRect(m_field->getRect()).intersects(viewRect))
+                    transforms.push_back(transform);
+    }
+    return transforms;
 }
 
-void FieldView::drawCone(RenderTarget& target, RenderStates states, Vector2f apex) const noexcept {
-    for (float rotation = 0.f; rotation < 360.f; rotation += 90.f) {
-        RenderStates currentStates = states;
-        currentStates.transform.rotate(rotation, apex);
-        drawField(target, currentStates);
+IntRect FieldView::getVisibleCellsRect() const noexcept {
+    FloatRect viewRect{m_view.getCenter() - m_view.getSize() / 2.f, m_view.getSize()};
+
+    Vector2f start = m_field->getSize();
+    Vector2f end{0.f, 0.f};
+    for (const Transform& transform : getVisibleTileTransforms()) {
+        FloatRect visible;
+        if (!transform.getInverse().transformRect(viewRect).intersects(m_field->getRect(), visible))
+            continue;
+
+        start.x = min(start.x, visible.left);
+        start.y = min(start.y, visible.top);
+        end.x = max(end.x, visible.left + visible.width);
+        end.y = max(end.y, visible.top + visible.height);
     }
 
-    RectangleShape fieldBorderShape;
-    fieldBorderShape.setFillColor(Color::Transparent);
-    fieldBorderShape.setOutlineColor(Color::Black);
-    fieldBorderShape.setOutlineThickness(1.f);
-    fieldBorderShape.setSize({2.f * m_field->getSize()});
-    fieldBorderShape.setOrigin(m_field->getSize());
-    fieldBorderShape.setPosition(apex);
-    target.draw(fieldBorderShape, states);
+    if (start.x >= end.x || start.y >= end.y) return IntRect{0, 0, 0, 0};
+
+    Vector2i startCell(floor(start.x), floor(start.y));
+    Vector2i endCell(min<int>(ceil(end.x), m_field->getWidth()), 
+                     min<int>(ceil(end.y), m_field->getHeight()));
+    return IntRect{startCell, endCell - startCell};
+}
+
+bool FieldView::renderFieldTexture() const noexcept {
+    unsigned int scale = std::ceil(getScreenToViewRatio());
+    unsigned int width = m_field->getWidth() * scale;
+    unsigned int height = m_field->getHeight() * scale;
+    if (max(width, height) > sf::Texture::getMaximumSize()) return false;
+
+    if (m_fieldTexture.getSize() != sf::Vector2u{width, height}) {
+        if (!m_fieldTexture.create(width, height)) return false;
+        m_fieldTexture.setSmooth(true);
+    }
+
+    m_fieldTexture.setView(View{m_field->getRect()});
+    m_fieldTexture.clear(Color::Transparent);
+    drawField(m_fieldTexture, RenderStates::Default);
+    m_fieldTexture.display();
+    return true;
+}
+
+void FieldView::drawTiles(RenderTarget& target, RenderStates states, 
+                          const vector<Transform>& transforms, 
+                          const sf::Texture& texture, Vector2f textureSize) const noexcept {
+    Vector2f fieldSize = m_field->getSize();
+    array<Vector2f, 4> corners{Vector2f{0.f, 0.f}, Vector2f{fieldSize.x, 0.f}, 
+                               fieldSize, Vector2f{0.f, fieldSize.y}};
+    array<Vector2f, 4> textureCorners{Vector2f{0.f, 0.f}, Vector2f{textureSize.x, 0.f}, 
+                                      textureSize, Vector2f{0.f, textureSize.y}};
+
+    sf::VertexArray quads{sf::Quads, 4 * transforms.size()};
+    for (int i = 0; i < ssize(transforms); ++ i)
+        for (int j = 0; j < 4; ++ j) {
+            quads[4 * i + j].position = transforms[i].transformPoint(corners[j]);
+            quads[4 * i + j].texCoords = textureCorners[j];
+            quads[4 * i + j].color = Color::White;
+    }
+
+    states.texture = &texture;
+    target.draw(quads, states);
+}
+
+void FieldView::drawFieldData(RenderTarget& target, RenderStates states, 
+                              bool details) const noexcept {
+    m_viewShader.setUniform("environment", sf::Shader::CurrentTexture);
+    m_viewShader.setUniform("bots", m_botsTexture);
+    m_viewShader.setUniform("species", m_speciesTexture);
+    m_viewShader.setUniform("fieldSize", m_field->getSize());
+    m_viewShader.setUniform("mode", static_cast<int>(m_mode));
+    m_viewShader.setUniform("details", details);
+    m_viewShader.setUniform("selected", Vector2f(m_selectedBot));
+
+    Vector2f fieldSize = m_field->getSize();
+    array<sf::Vertex, 4> quad{
+        sf::Vertex{{0.f, 0.f}, {0.f, 0.f}},
+        sf::Vertex{{fieldSize.x, 0.f}, {fieldSize.x, 0.f}},
+        sf::Vertex{fieldSize, fieldSize},
+        sf::Vertex{{0.f, fieldSize.y}, {0.f, fieldSize.y}}};
+
+    states.shader = &m_viewShader;
+    states.texture = &m_environmentTexture;
+    target.draw(quad.data(), quad.size(), sf::Quads, states);
+}
+
+void FieldView::renderOverviewTexture() const noexcept {
+    m_overviewTexture.setView(View{m_field->getRect()});
+    m_overviewTexture.clear(Color::Transparent);
+    drawFieldData(m_overviewTexture, RenderStates::Default, false);
+    m_overviewTexture.display();
+    m_overviewTexture.generateMipmap();
+}
+
+void FieldView::drawOverview(RenderTarget& target, RenderStates states, 
+                             const vector<Transform>& transforms) const noexcept {
+    if (hasShaderOverview()) {
+        drawTiles(target, states, transforms, m_overviewTexture.getTexture(), m_field->getSize());
+        return;
+    }
+
+    int level = getOverviewLevel();
+    drawTiles(target, states, transforms, m_mipLevels[level].texture, 
+              m_field->getSize() / static_cast<float>(m_overviewScale << level));
+
+    if (m_mode != Mode::LANDSCAPE && m_selectedBot != Vector2i(-1, -1)) {
+        RectangleShape selectedCellShape{{1.f, 1.f}};
+        selectedCellShape.setPosition(m_selectedBot.x, m_selectedBot.y);
+        selectedCellShape.setFillColor(Color::Red);
+        for (const Transform& transform : transforms) {
+            RenderStates currentStates = states;
+            currentStates.transform *= transform;
+            target.draw(selectedCellShape, currentStates);
+        }
+    }
+}
+
+Vector2f FieldView::getConeApex() const noexcept {
+    switch (m_field->getTopology().getId()) {
+    case Topology::Id::CONE_RIGHT_TOP:    return Vector2f(m_field->getWidth(), 0.f);
+    case Topology::Id::CONE_LEFT_BOTTOM:  return Vector2f(0.f, m_field->getHeight());
+    case Topology::Id::CONE_RIGHT_BOTTOM: return m_field->getSize();
+    default:                              return Vector2f(0.f, 0.f);
+    }
 }
 
 void FieldView::draw(RenderTarget& target, RenderStates states) const noexcept {
@@ -300,129 +918,57 @@ void FieldView::draw(RenderTarget& target, RenderStates states) const noexcept {
 
     target.setView(m_view);
 
-    Vector2f viewStart = m_view.getCenter() - m_view.getSize() / 2.f;
-    Vector2f viewEnd   = m_view.getCenter() + m_view.getSize() / 2.f;
+    if (hasShaderOverview() && m_overviewDirty) {
+        renderOverviewTexture();
+        m_overviewDirty = false;
+    }
 
-    switch (m_field->getTopology().getId()) {
-    case Topology::Id::TORUS: {
-            Vector2f renderStart{
-                getFirstInInterval(0.f, m_field->getWidth(), 
-                                   viewStart.x, viewEnd.x),
-                getFirstInInterval(0.f, m_field->getHeight(), 
-                                   viewStart.y, viewEnd.y)};
-
-            for (float y = renderStart.y; y < viewEnd.y; y += m_field->getHeight())
-                for (float x = renderStart.x; x < viewEnd.x; x += m_field->getWidth()) {
-                    RenderStates currentStates = states;
-                    currentStates.transform.translate(x, y);
-                    drawField(target, currentStates);
-            }
-            break;
-        }
-    case Topology::Id::CYLINDER_Y: {
-            float renderStart = getFirstInInterval(0.f, m_field->getHeight(), 
-                viewStart.y, viewEnd.y);
-
-            for (float y = renderStart; y < viewEnd.y; y += m_field->getHeight()) {
-                RenderStates currentStates = states;
-                currentStates.transform.translate(0, y);
-                drawField(target, currentStates);
-            }
-            
-            fieldBorderShape.setSize({m_field->getSize().x, m_view.getSize().y});
-            fieldBorderShape.setPosition(0.f,
-                                         m_view.getCenter().y - m_view.getSize().y / 2);
-            target.draw(fieldBorderShape, states);
-            break;
+    vector<Transform> transforms = getVisibleTileTransforms();
+    if (!shouldDrawDetails()) {
+        drawOverview(target, states, transforms);
+    } else if (ssize(transforms) > 1 && renderFieldTexture()) {
+        drawTiles(target, states, transforms, m_fieldTexture.getTexture(), 
+                  Vector2f(m_fieldTexture.getSize()));
+    } else {
+        for (const Transform& transform : transforms) {
+            RenderStates currentStates = states;
+            currentStates.transform *= transform;
+            drawField(target, currentStates);
         }
-    case Topology::Id::CYLINDER_X: {
-            float renderStart = getFirstInInterval(0.f, m_field->getHeight(), 
-                viewStart.x, viewEnd.x);
-
-            for (float x = renderStart; x < viewEnd.x; x += m_field->getHeight()) {
-                RenderStates currentStates = states;
-                currentStates.transform.translate(x, 0);
-                drawField(target, currentStates);
-            }
+    }
 
-            fieldBorderShape.setSize({m_view.getSize().x, m_field->getSize().y});
-            fieldBorderShape.setPosition(m_view.getCenter().x - m_view.getSize().x / 2, 
-                                         0.f);
-            target.draw(fieldBorderShape, states);
-            break;
-        }
+    switch (m_field->getTopology().getId()) {
+    case Topology::Id::CYLINDER_Y:
+        fieldBorderShape.setSize({m_field->getSize().x, m_view.getSize().y});
+        fieldBorderShape.setPosition(0.f, m_view.getCenter().y - m_view.getSize().y / 2);
+        target.draw(fieldBorderShape, states);
+        break;
+    case Topology::Id::CYLINDER_X:
+        fieldBorderShape.setSize({m_view.getSize().x, m_field->getSize().y});
+        fieldBorderShape.setPosition(m_view.getCenter().x - m_view.getSize().x / 2, 0.f);
+        target.draw(fieldBorderShape, states);
+        break;
     case Topology::Id::PLANE:
-        drawField(target, states);
         fieldBorderShape.setSize(m_field->getSize());
         fieldBorderShape.setPosition(0.f, 0.f);
         target.draw(fieldBorderShape, states);
         break;
-    case Topology::Id::SPHERE_LEFT: {
-            Vector2f renderStart{
-                getFirstInInterval(0.f, 2 * m_field->getWidth(), 
-                                   viewStart.x, viewEnd.x),
-                getFirstInInterval(0.f, 2 * m_field->getHeight(), 
-                                   viewStart.y, viewEnd.y)};
-
-            for (float y = renderStart.y; y < viewEnd.y; y += 2 * m_field->getHeight())
-                for (float x = renderStart.x; x < viewEnd.x; x += 2 * m_field->getWidth()) {
-                    RenderStates translatedStates = states;
-                    translatedStates.transform.translate(x, y);
-
-                    for (float rotation = 0.f; rotation < 360.f; rotation += 90.f) {
-                        RenderStates currentStates = translatedStates;
-                        currentStates.transform.rotate(rotation, m_field->getSize());
-                        drawField(target, currentStates);
-                    }
-            }
-            break;
-        }
-    case Topology::Id::SPHERE_RIGHT: {
-            Vector2f renderStart{
-                getFirstInInterval(0.f, 2 * m_field->getWidth(), 
-                                   viewStart.x, viewEnd.x),
-                getFirstInInterval(0.f, 2 * m_field->getHeight(), 
-                                   viewStart.y, viewEnd.y)};
-
-            for (float y = renderStart.y; y < viewEnd.y; y += 2 * m_field->getHeight())
-                for (float x = renderStart.x; x < viewEnd.x; x += 2 * m_field->getWidth()) {
-                    RenderStates translatedStates = states;
-                    translatedStates.transform.translate(x, y);
-                    drawField(target, translatedStates);
-
-                    RenderStates currentStates = translatedStates;
-                    currentStates.transform.rotate(-90.f, 
-                        0.f + m_field->getWidth(), 0.f);
-                    drawField(target, currentStates);
-
-                    currentStates = translatedStates;
-                    currentStates.transform.rotate(180.f, 
-                        0.f + m_field->getWidth(), 
-                        0.f + m_field->getHeight());
-                    drawField(target, currentStates);
-
-                    currentStates = translatedStates;
-                    currentStates.transform.rotate(90.f, 0.f, 
-                        0.f + m_field->getHeight());
-                    drawField(target, currentStates);
-            }
-            break;
-        }
     case Topology::Id::CONE_LEFT_TOP:
-        drawCone(target, states, Vector2f(0.f, 0.f));
-        break;
     case Topology::Id::CONE_RIGHT_TOP:
-        drawCone(target, states, Vector2f(m_field->getWidth(), 0));
-        break;
     case Topology::Id::CONE_LEFT_BOTTOM:
-        drawCone(target, states, Vector2f(0, m_field->getHeight()));
-        break;
     case Topology::Id::CONE_RIGHT_BOTTOM:
-        drawCone(target, states, m_field->getSize());
+        fieldBorderShape.setSize({2.f * m_field->getSize()});
+        fieldBorderShape.setOrigin(m_field->getSize());
+        fieldBorderShape.setPosition(getConeApex());
+        target.draw(fieldBorderShape, states);
+        break;
+    default:
         break;
     }
 
     target.setView(prevView);
+
+    drawMinimap(target, states);
 }
 
 void FieldView::showSelectBotTypeGui() noexcept {
@@ -433,7 +979,7 @@ void FieldView::showSelectBotTypeGui() noexcept {
         const bool is_selected = (m_selectedFile == -1);
         if (ImGui::Selectable("Random", is_selected)) {
             m_selectedFile = -1;
-            m_loadedBot.reset();
+            resetLoadedBot();
         }
             
         if (is_selected)
@@ -444,7 +990,7 @@ void FieldView::showSelectBotTypeGui() noexcept {
                 const bool is_selected = (m_selectedFile == i);
                 if (ImGui::Selectable(m_recentFiles[i].first.c_str(), is_selected)) {
                     m_selectedFile = i;
-                    m_loadedBot.reset();
+                    resetLoadedBot();
                 }
 
                 if (is_selected)
@@ -464,7 +1010,7 @@ void FieldView::showSelectBotTypeGui() noexcept {
                 if (ssize(m_recentFiles) >= 4) m_recentFiles.pop_back();
                 m_recentFiles.emplace_front(name, path);
                 m_selectedFile = 0;
-                m_loadedBot.reset();
+                resetLoadedBot();
             }
         }
 
@@ -472,6 +1018,31 @@ void FieldView::showSelectBotTypeGui() noexcept {
     }  
 }
 
+void FieldView::showLineageLogGui() noexcept {
+    if (m_lineageLog) {
+        Text("Lineage records: %llu, %.1f MB", 
+             static_cast<unsigned long long>(m_lineageLog->getWrittenRecords()), 
+             m_lineageLog->getWrittenBytes() / static_cast<double>(1 << 20));
+        if (Button("Stop lineage log")) stopLineageLog();
+        return;
+    }
+
+    if (Button("Start lineage log")) {
+        ImGuiFileDialog::Instance()->OpenDialog("Lineage log", "Choose File", 
+            ".lineage", ".", "", 1, nullptr, ImGuiFileDialogFlags_ConfirmOverwrite);
+    }
+
+    if (ImGuiFileDialog::Instance()->Display("Lineage log")) {
+        if (ImGuiFileDialog::Instance()->IsOk()) {
+            m_lineageLog = make_unique<LineageLog>(ImGuiFileDialog::Instance()->GetFilePathName());
+            if (m_lineageLog->isOpen()) m_field->addObserver(m_lineageLog.get());
+            else m_lineageLog.reset();
+        }
+
+        ImGuiFileDialog::Instance()->Close();
+    }
+}
+
 void FieldView::showSaveBotGui() noexcept {
     BeginDisabled(m_selectedBot == Vector2i(-1, -1));
     if (Button("Save selected bot")) {
@@ -485,8 +1056,9 @@ void FieldView::showSaveBotGui() noexcept {
             if (m_selectedBot != Vector2i(-1, -1)) {
                 ofstream file{ImGuiFileDialog::Instance()->GetFilePathName()};
 
-                Cell& cell = m_field->at(m_selectedBot.x, m_selectedBot.y);
-                file << cell.getBot() << std::endl;
+                const Cell& cell = as_const(*m_field).at(m_selectedBot.x, m_selectedBot.y);
+                cell.getBot().write(file, m_field->getSpeciesStore());
+                file << std::endl;
             }
         }
 
@@ -503,33 +1075,57 @@ void FieldView::showNewFieldTopologyCombo() noexcept {
 }
 
 void FieldView::setField(std::unique_ptr<Field>&& field) noexcept {
+    stopLineageLog();
+    resetLoadedBot();
     m_field = std::move(field);
 
     float side = std::max(m_field->getWidth(), m_field->getHeight());
     m_view.setSize(side, side);
     m_view.setCenter(m_field->getSize() / 2.f);
 
-    m_field->setView(this);
+    m_field->addObserver(this);
 
-    m_cellsVertices.resize(m_field->getWidth() * m_field->getHeight() * 6);
-    m_botsVertices.resize(m_field->getWidth() * m_field->getHeight() * 6);
-    for (int x = 0; x < m_field->getWidth(); ++ x)
-        for (int y = 0; y < m_field->getHeight(); ++ y) {
-            int offset = y * m_field->getWidth() * 6 + x * 6;
+    createMipLevels();
+    createDataTextures();
 
-            m_cellsVertices[offset].position = Vector2f(x, y);
-            m_cellsVertices[offset + 1].position = Vector2f(x + 1, y);
-            m_cellsVertices[offset + 2].position = Vector2f(x, y + 1);
-            m_cellsVertices[offset + 3].position = Vector2f(x + 1, y + 1);
-            m_cellsVertices[offset + 4].position = Vector2f(x + 1, y);
-            m_cellsVertices[offset + 5].position = Vector2f(x, y + 1);
+    m_cellsVertices.clear();
+    m_botsVertices.clear();
+}
 
-            m_botsVertices[offset].position = Vector2f(x + 0.1f, y + 0.1f);
-            m_botsVertices[offset + 1].position = Vector2f(x + 0.9f, y + 0.1f);
-            m_botsVertices[offset + 2].position = Vector2f(x + 0.1f, y + 0.9f);
-            m_botsVertices[offset + 3].position = Vector2f(x + 0.9f, y + 0.9f);
-            m_botsVertices[offset + 4].position = Vector2f(x + 0.9f, y + 0.1f);
-            m_botsVertices[offset + 5].position = Vector2f(x + 0.1f, y + 0.9f);
+void FieldView::handleBotEvents(span<const BotEvent> events, int) {
+    if (m_selectedBotId == BotIndex::NO_ID) return;
+
+    // only events of the selected bot move the selection
+    Vector2i position = m_selectedBot;
+    for (const BotEvent& event : events) {
+        if (event.botId != m_selectedBotId) continue;
+
+        if (event.type == BotEvent::Type::MOVED)
+            position = event.position;
+        else if (event.type == BotEvent::Type::DIED || event.type == BotEvent::Type::KILLED)
+            position = {-1, -1};
+    }
+    if (position == m_selectedBot) return;
+
+    if (position != Vector2i(-1, -1) && m_followSelectedBot) 
+        followSelectedBot(m_selectedBot, position);
+    selectBot(position);
+}
+
+void FieldView::followSelectedBot(Vector2i from, Vector2i to) noexcept {
+    // bots move by one cell, so longer steps cross a seam of the topology
+    Vector2i step = to - from;
+    if (step.x > m_field->getWidth() / 2) step.x -= m_field->getWidth();
+    if (step.x < -m_field->getWidth() / 2) step.x += m_field->getWidth();
+    if (step.y > m_field->getHeight() / 2) step.y -= m_field->getHeight();
+    if (step.y < -m_field->getHeight() / 2) step.y += m_field->getHeight();
+
+    if (abs(step.x) <= 1 && abs(step.y) <= 1) {
+        // copies of the field are drawn around it, so the view moves smoothly across the seam
+        m_view.move(Vector2f(step));
+    } else {
+        // seams that rotate or mirror the field
+        m_view.setCenter(Vector2f(to) + Vector2f(0.5f, 0.5f));
     }
 }
 
@@ -537,30 +1133,42 @@ void FieldView::showToolsWindow() noexcept {
     with_Window("Tools") {
     SliderFloat("Fill density", &m_fillDensity, 0.f, 1.f);
     if (Button("Random fill")) {
-        m_selectedBot = {-1, -1};
+        selectBot({-1, -1});
         m_field->randomFill(m_fillDensity);
+        m_fieldDataDirty = true;
         fill(m_statistics, m_field->computeStatistics());
     }
 
     if (Button("Clear")) {
-        m_selectedBot = {-1, -1};
+        selectBot({-1, -1});
         m_field->clear();
+        m_fieldDataDirty = true;
         fill(m_statistics, m_field->computeStatistics());
     }
 
     int tool = static_cast<int>(m_tool);
     Combo("Click tool", &tool, "Select bot\0Delete bot\0Place bot\0");
     m_tool = static_cast<Tool>(tool);
-    if (m_tool != Tool::SELECT_BOT) m_selectedBot = {-1, -1};
+    if (m_tool != Tool::SELECT_BOT) selectBot({-1, -1});
 
     showSelectBotTypeGui();
     showSaveBotGui();
+    showLineageLogGui();
+
+    Checkbox("Follow selected bot", &m_followSelectedBot);
+    if (m_selectedBotId != BotIndex::NO_ID) {
+        Text("Selected bot id: %llu", static_cast<unsigned long long>(m_selectedBotId));
+        const Bot& bot = as_const(*m_field).at(m_selectedBot.x, m_selectedBot.y).getBot();
+        const ControlFlow& controlFlow = m_field->getSpeciesStore().getControlFlow(bot.getSpecies());
+        Text("Reachable instructions: %i of 256", controlFlow.getReachableCount());
+    }
 }
 }
 
 void FieldView::showLifeCycleWindow() noexcept {
     with_Window("Life cycle") {
-        SliderInt("Lifetime", &m_field->getSettings().lifetime, 0, 1024);
+        // age is shown relative to the lifetime
+        if (SliderInt("Lifetime", &m_field->getSettings().lifetime, 0, 1024)) m_fieldDataDirty = true;
         SliderFloat("Mutation chance", &m_field->getSettings().mutationChance, 0, 1, 
                         "%.3f", ImGuiSliderFlags_Logarithmic);
         SliderFloat("Energy gain", &m_field->getSettings().energyGain, 0.f, 100.f);
@@ -568,6 +1176,8 @@ void FieldView::showLifeCycleWindow() noexcept {
         SliderFloat("Start energy", &m_field->getSettings().startEnergy, 1.f, 100.f);
         SliderFloat("Instruction cost", &m_field->getSettings().instructionCost, 0.f, 10.f, 
                     "%.3f", ImGuiSliderFlags_Logarithmic);
+        SliderInt("Instruction budget", &m_field->getSettings().instructionBudget, 16, 1 << 20, 
+                  "%d", ImGuiSliderFlags_Logarithmic);
         SliderFloat("Kill gain ratio", &m_field->getSettings().killGainRatio, 0.f, 2.f);
         SliderFloat("Eat efficiency", &m_field->getSettings().eatEfficiency, 0.f, 2.f);
         Checkbox("Eat action is long", &m_field->getSettings().eatLong);
@@ -588,8 +1198,70 @@ void FieldView::showLifeCycleWindow() noexcept {
         SliderFloat("Grass death rate", &m_field->getSettings().grassDeath, 0.f, 1.f);
         SliderFloat("Dead grass to organic ratio", &m_field->getSettings().deadGrassOrganicRatio, 
                     0.f, 16.f, "%.3f", ImGuiSliderFlags_Logarithmic);
+        BeginDisabled(m_field->getSettings().fixedPointEnergy);
         Checkbox("Total energy is fixed", &m_field->getSettings().preserveEnergy);
+        EndDisabled();
+        // compact environment can't hold every fixed point value
+        BeginDisabled(m_field->getEnvironmentFormat() != EnvironmentPlane::Format::DOUBLE);
+        if (Checkbox("Fixed point energy", &m_field->getSettings().fixedPointEnergy) 
+                && m_field->getSettings().fixedPointEnergy)
+            m_field->roundEnergy();
+        EndDisabled();
+    }
+}
+
+void FieldView::showCensusTable() noexcept {
+    SliderInt("Largest species", &m_censusSize, 1, 256, "%d", ImGuiSliderFlags_Logarithmic);
+    m_field->getCensus().findLargest(m_censusSize, m_censusRecords);
+
+    ImGuiTableFlags flags = ImGuiTableFlags_Sortable | ImGuiTableFlags_Borders 
+                          | ImGuiTableFlags_ScrollY | ImGuiTableFlags_SizingFixedFit;
+    if (!BeginTable("Census", 5, flags, ImVec2(0.f, 200.f))) return;
+
+    TableSetupColumn("Color", ImGuiTableColumnFlags_NoSort);
+    TableSetupColumn("Population", ImGuiTableColumnFlags_DefaultSort 
+                                   | ImGuiTableColumnFlags_PreferSortDescending);
+    TableSetupColumn("Peak", ImGuiTableColumnFlags_PreferSortDescending);
+    TableSetupColumn("First seen");
+    TableSetupColumn("Last seen");
+    TableHeadersRow();
+
+    // only the shown rows are sorted, they are already the largest species
+    if (ImGuiTableSortSpecs* sortSpecs = TableGetSortSpecs(); sortSpecs && sortSpecs->SpecsCount > 0) {
+        const ImGuiTableColumnSortSpecs& spec = sortSpecs->Specs[0];
+        auto key = [&spec] (const SpeciesCensus::Record& record) {
+            switch (spec.ColumnIndex) {
+            case 2: return record.peak;
+            case 3: return record.firstSeen;
+            case 4: return record.lastSeen;
+            default: return record.population;
+            }
+        };
+        std::ranges::stable_sort(m_censusRecords, [&] (const SpeciesCensus::Record& lhs, 
+                                                       const SpeciesCensus::Record& rhs) {
+            if (spec.SortDirection == ImGuiSortDirection_Descending) return key(lhs) > key(rhs);
+            return key(lhs) < key(rhs);
+        });
+    }
+
+    for (const SpeciesCensus::Record& record : m_censusRecords) {
+        TableNextRow();
+        TableNextColumn();
+        Color color = m_field->getSpeciesStore()[record.species].getColor();
+        with_ID (static_cast<int>(record.species.getValue())) {
+            ColorButton("##Color", ImVec4(color.r / 255.f, color.g / 255.f, color.b / 255.f, 1.f), 
+                        ImGuiColorEditFlags_NoTooltip);
+        }
+        TableNextColumn();
+        Text("%i", record.population);
+        TableNextColumn();
+        Text("%i", record.peak);
+        TableNextColumn();
+        Text("%i", record.firstSeen);
+        TableNextColumn();
+        Text("%i", record.lastSeen);
     }
+    EndTable();
 }
 
 void FieldView::showGui() noexcept {
@@ -598,8 +1270,22 @@ void FieldView::showGui() noexcept {
             int mode = static_cast<int>(m_mode);
             if (Combo("View mode", &mode, "Landscape\0Bots\0Food type\0Age\0Energy\0")) {
                 m_mode = static_cast<Mode>(mode);
+                m_overviewDirty = true;
+            }
+
+            int overviewMode = static_cast<int>(m_overviewMode);
+            if (Combo("Overview", &overviewMode, "Average\0Dominant\0")) {
+                m_overviewMode = static_cast<OverviewMode>(overviewMode);
+                markAllMipTilesDirty();
             }
 
+            BeginDisabled(!canUseShaders());
+            if (Checkbox("Use shaders", &m_useShaders) && m_useShaders) {
+                createDataTextures();
+                markAllMipTilesDirty();
+            }
+            EndDisabled();
+
             if (Button("To center")) {
                 m_view.setCenter(m_field->getSize() / 2.f);
             }
@@ -627,22 +1313,86 @@ void FieldView::showGui() noexcept {
             };
             PlotLines("##Total energy", totalEnergyGetter, &m_statistics, 
                       STATISTICS_HISTORY_SIZE, 0, NULL, 
-                      0.f, m_field->getWidth() * m_field->getHeight() * 512, ImVec2(0, 80.0f));
+                      0.f, 512.f * m_field->getWidth() * m_field->getHeight(), ImVec2(0, 80.0f));
+
+            Text("Allocated chunks: %i", m_statistics.back().allocatedChunks);
+            Text("Sleeping chunks: %i", m_statistics.back().sleepingChunks);
+            Text("Species: %i", m_statistics.back().species);
+            Text("Bots out of instruction budget: %i", m_statistics.back().cappedBots);
+            if (m_field->getSettings().memoizeDecisions)
+                Text("Decision cache hit rate: %.1f%%", 100.f * m_statistics.back().decisionCacheHitRate);
+            Text("Decisions per second: %.3g", m_statistics.back().decisionsPerSecond);
+            Text("Phylogeny nodes: %i", m_field->getSpeciesStore().getPhylogeny().getSize());
+            Text("Genomes: %i full, %i patched", 
+                 m_field->getSpeciesStore().getFullGenomeCount(), 
+                 m_field->getSpeciesStore().getPatchedGenomeCount());
+            showCensusTable();
+            if (Button("Export phylogeny")) {
+                ImGuiFileDialog::Instance()->OpenDialog("Export phylogeny", "Choose File", 
+                    ".csv", ".", "", 1, nullptr, ImGuiFileDialogFlags_ConfirmOverwrite);
+            }
+
+            if (ImGuiFileDialog::Instance()->Display("Export phylogeny")) {
+                if (ImGuiFileDialog::Instance()->IsOk()) {
+                    ofstream file{ImGuiFileDialog::Instance()->GetFilePathName()};
+                    m_field->getSpeciesStore().exportPhylogeny(file);
+                }
+
+                ImGuiFileDialog::Instance()->Close();
+            }
+            if (AllocationCounter::isEnabled())
+                Text("Allocations in the last epoch: %llu", 
+                     static_cast<unsigned long long>(m_updateAllocations));
+            // grass, organic and their diffused copies
+            int valueSize = EnvironmentPlane::getValueSize(m_field->getEnvironmentFormat());
+            Text("Environment memory: %.1f MB", 4.0 * valueSize * Field::CHUNK_AREA 
+                                                * m_statistics.back().allocatedChunks / (1 << 20));
         }
 
         showLifeCycleWindow();
 
         with_Window("Field") {
             showTopologyCombo();
-            if (Button("New")) m_field.reset();
+
+            Field::Settings& settings = m_field->getSettings();
+            Checkbox("Sleep still chunks", &settings.sleepChunks);
+            BeginDisabled(!settings.sleepChunks);
+            Checkbox("Exact sleep", &settings.exactSleep);
+            BeginDisabled(settings.exactSleep);
+            SliderFloat("Sleep epsilon", &settings.sleepEpsilon, 0.f, 1.f, 
+                        "%.1e", ImGuiSliderFlags_Logarithmic);
+            EndDisabled();
+            EndDisabled();
+
+            BeginDisabled(m_field->getEnvironmentFormat() == EnvironmentPlane::Format::DOUBLE);
+            Checkbox("Stochastic rounding", &settings.stochasticRounding);
+            EndDisabled();
+
+            Checkbox("Delta genomes", &settings.deltaGenomes);
+            Checkbox("Memoize decisions", &settings.memoizeDecisions);
+            BeginDisabled(settings.memoizeDecisions);
+            Checkbox("Lockstep decisions", &settings.lockstepDecisions);
+            EndDisabled();
+
+            if (Button("New")) {
+                stopLineageLog();
+                resetLoadedBot();
+                m_field.reset();
+            }
         }
     } else {
         with_Window("New field") {
-            SliderInt("Width", &m_fieldWidth, 16, 1024);
-            SliderInt("Height", &m_fieldHeight, 16, 1024);
+            SliderInt("Width", &m_fieldWidth, 16, 16384, "%d", ImGuiSliderFlags_Logarithmic);
+            SliderInt("Height", &m_fieldHeight, 16, 16384, "%d", ImGuiSliderFlags_Logarithmic);
             showNewFieldTopologyCombo();
+
+            int format = static_cast<int>(m_fieldEnvironmentFormat);
+            Combo("Environment", &format, "Double\0Fixed point 8.8\0Half float\0");
+            m_fieldEnvironmentFormat = static_cast<EnvironmentPlane::Format>(format);
+
             if (Button("Create")) {
-                setField(make_unique<Field>(m_fieldWidth, m_fieldHeight, m_randomEngine()));
+                setField(make_unique<Field>(m_fieldWidth, m_fieldHeight, m_randomEngine(), 
+                                            m_fieldEnvironmentFormat));
                 fill(m_statistics, m_field->computeStatistics());
                 m_field->setTopology(std::move(m_fieldTopology));
             }
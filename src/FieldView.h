@@ -15,6 +15,8 @@ If not, see <https://www.gnu.org/licenses/>. */
 #define FIELD_VIEW_H_
 
 #include "Field.h"
+#include "BotEvent.h"
+#include "LineageLog.h"
 
 #include <imgui.h>
 #include <imgui-SFML.h>
@@ -24,11 +26,13 @@ If not, see <https://www.gnu.org/licenses/>. */
 #include <SFML/System.hpp>
 
 #include <deque>
+#include <vector>
 #include <string>
 #include <utility>
 #include <algorithm>
+#include <span>
 
-class FieldView : public sf::Drawable {
+class FieldView : public sf::Drawable, public BotEventObserver {
 public:
     enum class Tool {
         SELECT_BOT = 0,
@@ -44,6 +48,11 @@ public:
         ENERGY,
     };
 
+    enum class OverviewMode {
+        AVERAGE = 0,
+        DOMINANT,
+    };
+
     FieldView(sf::Vector2f screenSize, uint64_t seed);
 
     // return true if handled
@@ -78,31 +87,20 @@ public:
         return m_paused ? 0.f : m_simulationSpeed;
     }
 
-    bool handleBotMoved(sf::Vector2i from, sf::Vector2i to) noexcept {
-        if (from == m_selectedBot) {
-            selectBot(to);
-            return true;
-        }
-        return false;
-    }
-
-    bool handleBotDied(sf::Vector2i coords) noexcept {
-        if (coords == m_selectedBot) {
-            selectBot({-1, -1});
-            return true;
-        }
-        return false;
-    }
+    // keeps the selection on the selected bot
+    void handleBotEvents(std::span<const BotEvent> events, int epoch) override;
 private:
     std::unique_ptr<Field> m_field;
 
     int m_fieldWidth;
     int m_fieldHeight;
     std::unique_ptr<Topology> m_fieldTopology;
+    EnvironmentPlane::Format m_fieldEnvironmentFormat;
     std::mt19937_64 m_randomEngine;
 
     sf::VertexArray m_cellsVertices;
     sf::VertexArray m_botsVertices;
+    sf::VertexArray m_directionsVertices;
 
     sf::View m_view;
 
@@ -118,6 +116,9 @@ private:
 
     Tool m_tool;
     sf::Vector2i m_selectedBot;
+    // the selection follows the bot by its id
+    uint64_t m_selectedBotId;
+    bool m_followSelectedBot;
     sf::RectangleShape m_selectionShape;
 
     Mode m_mode;
@@ -126,7 +127,53 @@ private:
     int m_selectedFile;
     std::unique_ptr<Bot> m_loadedBot;
 
+    // observes the field while logging
+    std::unique_ptr<LineageLog> m_lineageLog;
+
     std::deque<Field::Statistics> m_statistics;
+    // heap allocations made by the last update, counted only if built with COUNT_ALLOCATIONS
+    uint64_t m_updateAllocations;
+
+    // species with the largest population shown in the Statistics window
+    int m_censusSize;
+    std::vector<SpeciesCensus::Record> m_censusRecords;
+
+    // level 0 has one texel per m_overviewScale cells, each next level halves the resolution
+    struct MipLevel {
+        int width;
+        int height;
+        std::vector<sf::Color> colors;
+        
+        int tilesX;
+        int tilesY;
+        std::vector<bool> dirtyTiles;
+
+        sf::Texture texture;
+    };
+
+    std::vector<MipLevel> m_mipLevels;
+    // cells per texel side of level 0, more than 1 only for very big fields
+    int m_overviewScale;
+    std::vector<sf::Color> m_mipUploadBuffer;
+    OverviewMode m_overviewMode;
+
+    // detailed field rendered once per frame and reused for every visible copy of it
+    mutable sf::RenderTexture m_fieldTexture;
+
+    // raw per cell data, colored by m_viewShader according to m_mode
+    bool m_useShaders;
+    mutable sf::Shader m_viewShader;
+    std::vector<sf::Color> m_environmentData;
+    std::vector<sf::Color> m_botsData;
+    std::vector<sf::Color> m_speciesData;
+    sf::Texture m_environmentTexture;
+    sf::Texture m_botsTexture;
+    sf::Texture m_speciesTexture;
+    mutable sf::RenderTexture m_overviewTexture;
+    // the field changed since the data textures were uploaded
+    bool m_fieldDataDirty;
+    // data, view mode or selection changed since the overview texture was rendered
+    mutable bool m_overviewDirty;
 
     float m_baseZoomingChange;
     float m_baseMovingSpeed;
@@ -143,9 +190,17 @@ private:
 
     void setField(std::unique_ptr<Field>&& field) noexcept;
 
+    void stopLineageLog() noexcept {
+        if (m_field && m_lineageLog) m_field->removeObserver(m_lineageLog.get());
+        m_lineageLog.reset();
+    }
+
     void selectBot(sf::Vector2i coords) noexcept {
         m_selectedBot = coords;
+        m_selectedBotId = BotIndex::NO_ID;
+        m_overviewDirty = true;
         if (coords != sf::Vector2i{-1, -1}) {
+            m_selectedBotId = std::as_const(*m_field).at(coords.x, coords.y).getBot().getId();
             m_selectionShape.setSize({1.5f, 1.5f});
             m_selectionShape.setPosition(coords.x, coords.y);
         }
@@ -153,6 +208,13 @@ private:
 
     void selectFile(int index) noexcept {
         m_selectedFile = index;
+        resetLoadedBot();
+    }
+
+    // loaded bot isn't in the field, so its species is pinned in the store of the field,
+    // the bot is reset before the field is replaced
+    void resetLoadedBot() noexcept {
+        if (m_loadedBot && m_field) m_field->getSpeciesStore().unpin(m_loadedBot->getSpecies());
         m_loadedBot.reset();
     }
 
@@ -164,20 +226,76 @@ private:
         return false;
     }
 
-    sf::Color getCellColor(const Cell& cell) const noexcept {
-        return sf::Color(std::min(cell.getOrganic(), 255.0), std::min(cell.getGrass(), 255.0), 0);
+    sf::Color getCellColor(int x, int y) const noexcept {
+        return sf::Color(std::min(m_field->getOrganic(x, y), 255.0), 
+                         std::min(m_field->getGrass(x, y), 255.0), 0);
     }
 
     sf::Color getBotColor(const Cell& cell) const noexcept;
 
+    sf::Color getOverviewColor(int x, int y) const noexcept {
+        const Cell& cell = std::as_const(*m_field).at(x, y);
+        if (m_mode != Mode::LANDSCAPE && cell.hasBot()) 
+            return getBotColor(cell);
+        return getCellColor(x, y);
+    }
+
+    bool shouldDrawDetails() const noexcept {
+        return 0.25f * getScreenToViewRatio() >= 1.f && m_mode != Mode::LANDSCAPE;
+    }
+
+    bool canUseShaders() const noexcept;
+    void createDataTextures() noexcept;
+    void updateDataTextures() noexcept;
+    // shader overview is mipmapped on GPU, CPU pyramid is used otherwise
+    bool hasShaderOverview() const noexcept {
+        return m_useShaders && m_overviewMode == OverviewMode::AVERAGE;
+    }
+
+    void createMipLevels() noexcept;
+    void setOverviewColor(int x, int y, sf::Color color) noexcept;
+    void markAllMipTilesDirty() noexcept;
+    void updateMipLevels() noexcept;
+    sf::Color computeMipColor(const MipLevel& previous, int x, int y) const noexcept;
+
+    int getOverviewLevel() const noexcept;
+    int getMinimapLevel() const noexcept;
+    sf::FloatRect getMinimapRect(sf::Vector2f screenViewSize) const noexcept;
+
+    void drawMipLevel(sf::RenderTarget& target, sf::RenderStates states, 
+                      int level, sf::Vector2f position, sf::Vector2f size) const noexcept;
+    void drawMinimap(sf::RenderTarget& target, sf::RenderStates states) const noexcept;
+
+    // transforms of the field copies intersecting the view
+    std::vector<sf::Transform> getVisibleTileTransforms() const noexcept;
+    // bounding rect of the cells seen in any copy
+    sf::IntRect getVisibleCellsRect() const noexcept;
+
+    void updateCellsVertices() noexcept;
+    void updateDirectionsVertices() noexcept;
+    sf::Vector2f getConeApex() const noexcept;
+
+    // return false if the field can't fit in a texture at current zoom
+    bool renderFieldTexture() const noexcept;
+
+    void drawTiles(sf::RenderTarget& target, sf::RenderStates states, 
+                   const std::vector<sf::Transform>& transforms, 
+                   const sf::Texture& texture, sf::Vector2f textureSize) const noexcept;
+    void drawOverview(sf::RenderTarget& target, sf::RenderStates states, 
+                      const std::vector<sf::Transform>& transforms) const noexcept;
+    void drawFieldData(sf::RenderTarget& target, sf::RenderStates states, 
+                       bool details) const noexcept;
+    void renderOverviewTexture() const noexcept;
     void drawField(sf::RenderTarget& target, sf::RenderStates states) const noexcept;
-    void drawCone(sf::RenderTarget& target, sf::RenderStates states, sf::Vector2f apex) const noexcept;
 
     void showToolsWindow() noexcept;
     void showLifeCycleWindow() noexcept;
+    void showCensusTable() noexcept;
 
     void showSelectBotTypeGui() noexcept;
     void showSaveBotGui() noexcept;
+    void showLineageLogGui() noexcept;
+    void followSelectedBot(sf::Vector2i from, sf::Vector2i to) noexcept;
     void showTopologyCombo() noexcept;
     void showNewFieldTopologyCombo() noexcept;
 
@@ -0,0 +1,142 @@
+/* This file is part of JCyberEvolution.
+
+JCyberEvolution is free software: you can redistribute it and/or modify it 
+under the terms of the GNU General Public License as published by the Free Software Foundation, 
+either version 3 of the License, or (at your option) any later version.
+
+JCyberEvolution is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with JCyberEvolution. 
+If not, see <https://www.gnu.org/licenses/>. */
+
+#include "LineageLog.h"
+#include "BotEvent.h"
+
+#include <span>
+using std::span;
+
+#include <vector>
+using std::vector;
+using std::ssize;
+
+#include <string>
+using std::string;
+
+#include <fstream>
+using std::ofstream;
+using std::ios;
+
+#include <thread>
+using std::thread;
+namespace this_thread = std::this_thread;
+
+#include <chrono>
+using std::chrono::milliseconds;
+
+#include <atomic>
+using std::memory_order_relaxed;
+using std::memory_order_acquire;
+using std::memory_order_release;
+
+#include <cstring>
+using std::memcpy;
+
+LineageLog::LineageLog(const string& path) : 
+        m_buffer{}, m_file{path, ios::binary}, m_stopping{false}, 
+        m_writtenRecords{0}, m_writtenBytes{0}, m_stalls{0}, 
+        m_block{}, m_encoded{}, m_writer{} {
+    if (!m_file.is_open()) return;
+
+    m_file.write(MAGIC, sizeof(MAGIC));
+    m_block.reserve(BLOCK_SIZE);
+    m_writer = thread{&LineageLog::write, this};
+}
+
+LineageLog::~LineageLog() {
+    m_stopping.store(true, memory_order_release);
+    if (m_writer.joinable()) m_writer.join();
+}
+
+void LineageLog::handleBotEvents(span<const BotEvent> events, int epoch) {
+    if (!m_file.is_open()) return;
+
+    for (const BotEvent& event : events) {
+        if (event.type == BotEvent::Type::MOVED) continue;
+
+        LineageRecord record{event.botId, event.parentId, event.species.getValue(), epoch, 
+                             event.position.x, event.position.y, event.energy, 
+                             event.type, event.death};
+        // the simulation waits instead of losing records
+        while (!m_buffer.tryPush(record)) {
+            ++ m_stalls;
+            this_thread::yield();
+        }
+    }
+}
+
+void LineageLog::write() {
+    while (true) {
+        // records pushed before stopping are popped after this load
+        bool stopping = m_stopping.load(memory_order_acquire);
+
+        LineageRecord record;
+        bool popped = false;
+        while (ssize(m_block) < BLOCK_SIZE && m_buffer.tryPop(record)) {
+            m_block.push_back(record);
+            popped = true;
+        }
+
+        if (ssize(m_block) == BLOCK_SIZE) {
+            writeBlock();
+        } else if (!popped) {
+            if (stopping) break;
+            this_thread::sleep_for(milliseconds{1});
+        }
+    }
+
+    writeBlock();
+    m_file.flush();
+}
+
+void LineageLog::writeBlock() {
+    if (m_block.empty()) return;
+
+    m_encoded.clear();
+    LineageRecord previous{};
+    for (const LineageRecord& record : m_block) {
+        // the epoch starts from 0 again after the field is cleared or filled
+        encodeVarint(m_encoded, encodeZigzag(static_cast<int64_t>(record.epoch) - previous.epoch));
+        encodeVarint(m_encoded, encodeZigzag(static_cast<int64_t>(record.botId - previous.botId)));
+        encodeVarint(m_encoded, record.parentId == 0 ? 0 : record.botId - record.parentId);
+        encodeVarint(m_encoded, record.species);
+        encodeVarint(m_encoded, encodeZigzag(record.x - previous.x));
+        encodeVarint(m_encoded, encodeZigzag(record.y - previous.y));
+        m_encoded.push_back(static_cast<uint8_t>(static_cast<int>(record.type) 
+                                                 | static_cast<int>(record.death) << 2));
+
+        uint8_t energy[sizeof(float)];
+        memcpy(energy, &record.energy, sizeof(float));
+        m_encoded.insert(m_encoded.end(), energy, energy + sizeof(float));
+        previous = record;
+    }
+
+    vector<uint8_t> header;
+    encodeVarint(header, m_block.size());
+    encodeVarint(header, m_encoded.size());
+    m_file.write(reinterpret_cast<const char*>(header.data()), header.size());
+    m_file.write(reinterpret_cast<const char*>(m_encoded.data()), m_encoded.size());
+
+    m_writtenRecords.fetch_add(m_block.size(), memory_order_relaxed);
+    m_writtenBytes.fetch_add(header.size() + m_encoded.size(), memory_order_relaxed);
+    m_block.clear();
+}
+
+void LineageLog::encodeVarint(vector<uint8_t>& bytes, uint64_t value) {
+    while (value >= 0x80) {
+        bytes.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    bytes.push_back(static_cast<uint8_t>(value));
+}
@@ -0,0 +1,102 @@
+/* This file is part of JCyberEvolution.
+
+JCyberEvolution is free software: you can redistribute it and/or modify it 
+under the terms of the GNU General Public License as published by the Free Software Foundation, 
+either version 3 of the License, or (at your option) any later version.
+
+JCyberEvolution is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with JCyberEvolution. 
+If not, see <https://www.gnu.org/licenses/>. */
+
+#ifndef LINEAGE_LOG_H_
+#define LINEAGE_LOG_H_
+
+#include "BotEvent.h"
+#include "RingBuffer.h"
+
+#include <span>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <thread>
+#include <atomic>
+#include <cstdint>
+
+// birth or death of a bot
+struct LineageRecord {
+    uint64_t botId;
+    // 0 for deaths and bots placed from outside of the simulation
+    uint64_t parentId;
+    uint32_t species;
+    int32_t epoch;
+    int32_t x;
+    int32_t y;
+    float energy;
+    BotEvent::Type type;
+    DeathCause death;
+};
+
+// births and deaths streamed to a file by a background thread,
+// the file starts with MAGIC, then blocks follow, each one is
+// varint record count, varint byte size and records encoded relative to the previous one:
+// zigzag varint epoch delta, zigzag varint id delta, varint id minus parent id (0 without parent),
+// varint species, zigzag varint x and y deltas, byte type | death << 2, float energy
+class LineageLog : public BotEventObserver {
+public:
+    static constexpr char MAGIC[8] = {'J', 'C', 'E', 'L', 'I', 'N', '0', '2'};
+
+    // starts the writer, check isOpen
+    explicit LineageLog(const std::string& path);
+
+    // writes all logged records before returning
+    ~LineageLog();
+
+    bool isOpen() const noexcept {
+        return m_file.is_open();
+    }
+
+    // births, deaths and kills are logged, moves aren't
+    void handleBotEvents(std::span<const BotEvent> events, int epoch) override;
+
+    uint64_t getWrittenRecords() const noexcept {
+        return m_writtenRecords.load(std::memory_order_relaxed);
+    }
+
+    uint64_t getWrittenBytes() const noexcept {
+        return m_writtenBytes.load(std::memory_order_relaxed);
+    }
+
+    // times the simulation waited for the writer
+    uint64_t getStalls() const noexcept {
+        return m_stalls;
+    }
+private:
+    static constexpr int BUFFER_SIZE = 1 << 16;
+    static constexpr int BLOCK_SIZE = 4096;
+
+    RingBuffer<LineageRecord, BUFFER_SIZE> m_buffer;
+    std::ofstream m_file;
+    std::atomic<bool> m_stopping;
+    std::atomic<uint64_t> m_writtenRecords;
+    std::atomic<uint64_t> m_writtenBytes;
+    uint64_t m_stalls;
+
+    // used by the writer only
+    std::vector<LineageRecord> m_block;
+    std::vector<uint8_t> m_encoded;
+    std::thread m_writer;
+
+    void write();
+    void writeBlock();
+
+    static void encodeVarint(std::vector<uint8_t>& bytes, uint64_t value);
+
+    static uint64_t encodeZigzag(int64_t value) noexcept {
+        return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    }
+};
+
+#endif
@@ -0,0 +1,300 @@
+/* This file is part of JCyberEvolution.
+
+JCyberEvolution is free software: you can redistribute it and/or modify it 
+under the terms of the GNU General Public License as published by the Free Software Foundation, 
+either version 3 of the License, or (at your option) any later version.
+
+JCyberEvolution is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with JCyberEvolution. 
+If not, see <https://www.gnu.org/licenses/>. */
+
+#include "LockstepInterpreter.h"
+#include "Bot.h"
+#include "Field.h"
+#include "SpeciesStore.h"
+#include "ControlFlow.h"
+
+#include <vector>
+using std::vector;
+
+#include <algorithm>
+using std::sort;
+
+#include <cstdint>
+
+LockstepInterpreter::LockstepInterpreter() noexcept :
+        m_bots{}, m_states{}, m_indices{}, m_order{}, m_decisionGenomes{}, m_genomeCopies{},
+        m_decisions{}, m_genomes{},
+        m_controlFlows{}, m_instructionPointers{}, m_rotations{}, m_energies{}, m_organics{},
+        m_executed{}, m_cycleStarts{}, m_cyclePowers{}, m_cycleLengths{}, m_cycleSteps{},
+        m_grass{}, m_organicInCell{}, m_emptyNeighbours{}, m_occupiedNeighbours{} {}
+
+void LockstepInterpreter::allocate() {
+    m_bots.reserve(Field::CHUNK_AREA);
+    m_states.reserve(Field::CHUNK_AREA);
+    m_indices.reserve(Field::CHUNK_AREA);
+    m_order.reserve(Field::CHUNK_AREA);
+    m_decisionGenomes.reserve(Field::CHUNK_AREA);
+}
+
+void LockstepInterpreter::clear() noexcept {
+    m_bots.clear();
+    m_states.clear();
+    m_indices.clear();
+    m_order.clear();
+    m_decisionGenomes.clear();
+    m_genomeCopies.clear();
+}
+
+void LockstepInterpreter::add(Bot& bot, const Bot::DecisionState& state, int index) noexcept {
+    m_order.push_back(getSize());
+    m_bots.push_back(&bot);
+    m_decisionGenomes.push_back(nullptr);
+    m_states.push_back(state);
+    m_indices.push_back(index);
+}
+
+void LockstepInterpreter::run(const Field& field) noexcept {
+    // lanes of one species read the same genome and control flow
+    sort(m_order.begin(), m_order.end(), [this] (int lhs, int rhs) {
+        return m_bots[lhs]->m_species.getValue() < m_bots[rhs]->m_species.getValue();
+    });
+    collectGenomes(field);
+
+    int next = 0;
+    int active = 0;
+    while (true) {
+        // retired lanes are refilled, so they stay busy while there are decisions
+        while (active < LANES && next < getSize())
+            load(active ++, m_order[next ++], field);
+        if (active == 0) break;
+
+        for (int lane = 0; lane < active; ) {
+            if (step(lane, field)) {
+                ++ lane;
+            } else {
+                store(lane);
+                move(-- active, lane);
+            }
+        }
+    }
+}
+
+void LockstepInterpreter::collectGenomes(const Field& field) {
+    const SpeciesStore& store = field.getSpeciesStore();
+    // all copies are made before their addresses are taken, as the vector may grow
+    m_genomeCopies.clear();
+    for (int i = 0; i < getSize(); ++ i) {
+        SpeciesHandle species = m_bots[m_order[i]]->m_species;
+        bool first = i == 0 || species != m_bots[m_order[i - 1]]->m_species;
+        if (first && store.isPatched(species)) m_genomeCopies.push_back(store[species]);
+    }
+
+    int copy = 0;
+    const Species* genome = nullptr;
+    for (int i = 0; i < getSize(); ++ i) {
+        SpeciesHandle species = m_bots[m_order[i]]->m_species;
+        if (i == 0 || species != m_bots[m_order[i - 1]]->m_species)
+            genome = store.isPatched(species) ? &m_genomeCopies[copy ++] : &store[species];
+        m_decisionGenomes[m_order[i]] = genome;
+    }
+}
+
+void LockstepInterpreter::load(int lane, int decision, const Field& field) noexcept {
+    const Bot& bot = *m_bots[decision];
+    const Bot::DecisionState& state = m_states[decision];
+    m_decisions[lane] = decision;
+    m_genomes[lane] = m_decisionGenomes[decision];
+    m_controlFlows[lane] = &field.getSpeciesStore().getControlFlow(bot.m_species);
+    m_instructionPointers[lane] = bot.m_instructionPointer;
+    m_rotations[lane] = bot.m_rotation;
+    m_energies[lane] = bot.m_energy;
+    m_organics[lane] = state.decision.organic;
+    m_executed[lane] = state.executed;
+    m_cycleStarts[lane] = state.cycleStart;
+    m_cyclePowers[lane] = state.cyclePower;
+    m_cycleLengths[lane] = state.cycleLength;
+    m_cycleSteps[lane] = state.cycleSteps;
+    m_grass[lane] = field.getGrass(bot.m_position.x, bot.m_position.y);
+    m_organicInCell[lane] = field.getOrganic(bot.m_position.x, bot.m_position.y);
+    const Field::NeighbourMasks& masks = field.getNeighbourMasks(bot.m_position.x, bot.m_position.y);
+    m_emptyNeighbours[lane] = masks.empty;
+    m_occupiedNeighbours[lane] = masks.occupied;
+}
+
+void LockstepInterpreter::store(int lane) noexcept {
+    Bot& bot = *m_bots[m_decisions[lane]];
+    Bot::DecisionState& state = m_states[m_decisions[lane]];
+    bot.m_instructionPointer = m_instructionPointers[lane];
+    bot.m_rotation = m_rotations[lane];
+    bot.m_energy = m_energies[lane];
+    state.decision.organic = m_organics[lane];
+    state.executed = m_executed[lane];
+    state.cycleStart = m_cycleStarts[lane];
+    state.cyclePower = m_cyclePowers[lane];
+    state.cycleLength = m_cycleLengths[lane];
+    state.cycleSteps = m_cycleSteps[lane];
+}
+
+void LockstepInterpreter::move(int from, int to) noexcept {
+    m_decisions[to] = m_decisions[from];
+    m_genomes[to] = m_genomes[from];
+    m_controlFlows[to] = m_controlFlows[from];
+    m_instructionPointers[to] = m_instructionPointers[from];
+    m_rotations[to] = m_rotations[from];
+    m_energies[to] = m_energies[from];
+    m_organics[to] = m_organics[from];
+    m_executed[to] = m_executed[from];
+    m_cycleStarts[to] = m_cycleStarts[from];
+    m_cyclePowers[to] = m_cyclePowers[from];
+    m_cycleLengths[to] = m_cycleLengths[from];
+    m_cycleSteps[to] = m_cycleSteps[from];
+    m_grass[to] = m_grass[from];
+    m_organicInCell[to] = m_organicInCell[from];
+    m_emptyNeighbours[to] = m_emptyNeighbours[from];
+    m_occupiedNeighbours[to] = m_occupiedNeighbours[from];
+}
+
+bool LockstepInterpreter::useInstructionsEnergy(int lane, int count, const Field& field) noexcept {
+    double energy = m_energies[lane];
+    double organic = m_organics[lane];
+    for (int i = 0; i < count; ++ i) {
+        if (energy <= 0) return false;
+        organic += Bot::spendEnergy(energy, field.getSettings().instructionCost, field);
+    }
+    m_energies[lane] = energy;
+    m_organics[lane] = organic;
+    return true;
+}
+
+bool LockstepInterpreter::step(int lane, const Field& field) noexcept {
+    using Instruction = Bot::Instruction;
+
+    int budget = field.getSettings().instructionBudget;
+    float instructionCost = field.getSettings().instructionCost;
+    if (m_executed[lane] == budget || m_energies[lane] <= 0) return false;
+
+    const Species& species = *m_genomes[lane];
+    int instructionPointer = m_instructionPointers[lane];
+    int rotation = m_rotations[lane];
+    uint16_t code = species[instructionPointer];
+    // fixed codes are decoded as by Bot::decodeRotation and Bot::decodeAddress
+    auto decodeRotation = [rotation] (uint16_t code) {
+        return code & (1 << 4) ? (rotation + code % 8) % 8 : code % 8;
+    };
+    auto decodeAddress = [instructionPointer] (uint16_t code) {
+        return code & (1 << 9) ? (instructionPointer + code % 256) % 256 : code % 256;
+    };
+    auto hasFixedTest = [&species, instructionPointer] () {
+        return Bot::isFixedAddress(species[(instructionPointer + 1) % 256])
+            && Bot::isFixedAddress(species[(instructionPointer + 2) % 256]);
+    };
+
+    bool pure = true;
+    int length = 1;
+    const ControlFlow::Step& run = (*m_controlFlows[lane])[instructionPointer];
+    if (Bot::isControlFlow(code) && run.length > 1 && budget - m_executed[lane] >= run.length
+        && useInstructionsEnergy(lane, run.length, field)) {
+        instructionPointer = run.target;
+        if (run.rotation == ControlFlow::Rotation::TURN)
+            rotation = (rotation + run.rotationValue) % 8;
+        else if (run.rotation == ControlFlow::Rotation::SET)
+            rotation = run.rotationValue;
+        length = run.length;
+    } else {
+        uint16_t argument = species[(instructionPointer + 1) % 256];
+        switch (static_cast<Instruction>(code % 16)) {
+        case Instruction::ROTATE:
+            if (!Bot::isFixedRotation(argument)) return false;
+            rotation = decodeRotation(argument);
+            instructionPointer += 2;
+            break;
+        case Instruction::JMP:
+            if (!Bot::isFixedAddress(argument)) return false;
+            instructionPointer = decodeAddress(argument);
+            break;
+        case Instruction::TEST_EMPTY:
+        case Instruction::TEST_ENEMY:
+        case Instruction::TEST_ALLY: {
+            uint16_t directionCode = species[(instructionPointer + 3) % 256];
+            if (!hasFixedTest() || !Bot::isFixedRotation(directionCode)) return false;
+            int direction = decodeRotation(directionCode);
+            if (direction < 0 || direction >= 8) return false;
+            // genomes of neighbours are compared by the scalar interpreter
+            uint8_t bit = static_cast<uint8_t>(1 << direction);
+            bool result = code % 16 == static_cast<int>(Instruction::TEST_EMPTY)
+                        ? m_emptyNeighbours[lane] & bit : false;
+            if (!result && (m_occupiedNeighbours[lane] & bit)) return false;
+            instructionPointer = decodeAddress(species[(instructionPointer + (result ? 1 : 2)) % 256]);
+            break;
+        }
+        case Instruction::TEST_ENERGY:
+        case Instruction::TEST_GRASS:
+        case Instruction::TEST_ORGANIC: {
+            if (!hasFixedTest()) return false;
+            uint16_t threshold = species[(instructionPointer + 3) % 256];
+            bool result;
+            if (code % 16 == static_cast<int>(Instruction::TEST_ENERGY)) {
+                result = m_energies[lane] > threshold;
+                // energy changes with every instruction unless they are free
+                pure = instructionCost == 0.f;
+            } else if (code % 16 == static_cast<int>(Instruction::TEST_GRASS)) {
+                result = m_grass[lane] > threshold % 256;
+            } else {
+                result = m_organicInCell[lane] > threshold % 256;
+            }
+            instructionPointer = decodeAddress(species[(instructionPointer + (result ? 1 : 2)) % 256]);
+            break;
+        }
+        case Instruction::MOVE:
+        case Instruction::EAT:
+        case Instruction::SKIP:
+        case Instruction::DIE:
+        case Instruction::MULTIPLY:
+        case Instruction::ATTACK:
+            return false;
+        default:
+            ++ instructionPointer;
+            break;
+        }
+        m_organics[lane] += Bot::spendEnergy(m_energies[lane], instructionCost, field);
+    }
+    m_executed[lane] += length;
+    m_instructionPointers[lane] = instructionPointer % 256;
+    m_rotations[lane] = rotation;
+
+    if (!pure) {
+        m_cycleStarts[lane] = -1;
+        m_cyclePowers[lane] = 1;
+        m_cycleLengths[lane] = 0;
+        m_cycleSteps[lane] = 0;
+        return true;
+    }
+
+    int state = m_instructionPointers[lane] << 8 | (rotation & 0xff);
+    m_cycleLengths[lane] += length;
+    ++ m_cycleSteps[lane];
+    if (state == m_cycleStarts[lane]) {
+        int cycleLength = m_cycleLengths[lane];
+        if (instructionCost == 0.f) {
+            m_executed[lane] += (budget - m_executed[lane]) / cycleLength * cycleLength;
+        } else {
+            while (budget - m_executed[lane] >= cycleLength
+                   && useInstructionsEnergy(lane, cycleLength, field))
+                m_executed[lane] += cycleLength;
+        }
+        m_cycleStarts[lane] = -1;
+        m_cyclePowers[lane] = 1;
+        m_cycleLengths[lane] = 0;
+        m_cycleSteps[lane] = 0;
+    } else if (m_cycleSteps[lane] == m_cyclePowers[lane]) {
+        m_cycleStarts[lane] = state;
+        m_cyclePowers[lane] *= 2;
+        m_cycleLengths[lane] = 0;
+        m_cycleSteps[lane] = 0;
+    }
+    return true;
+}
@@ -0,0 +1,105 @@
+/* This file is part of JCyberEvolution.
+
+JCyberEvolution is free software: you can redistribute it and/or modify it 
+under the terms of the GNU General Public License as published by the Free Software Foundation, 
+either version 3 of the License, or (at your option) any later version.
+
+JCyberEvolution is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with JCyberEvolution. 
+If not, see <https://www.gnu.org/licenses/>. */
+
+#ifndef LOCKSTEP_INTERPRETER_H_
+#define LOCKSTEP_INTERPRETER_H_
+
+#include "Bot.h"
+
+#include <array>
+#include <vector>
+#include <cstdint>
+
+class Field;
+
+// runs the start of the decisions of a chunk in lockstep, one instruction per lane at a time,
+// over arrays of lane state, bots of the same species share lanes one after another,
+// a lane retires before an instruction that needs the random engine or has effects
+// outside of its bot, then Bot::finishDecision goes on from there in the usual order,
+// so random numbers are drawn as by makeDecision and results are the same
+class LockstepInterpreter {
+public:
+    static constexpr int LANES = 16;
+
+    LockstepInterpreter() noexcept;
+
+    // reserves space for a chunk, so adding bots doesn't allocate
+    void allocate();
+
+    void clear() noexcept;
+    // index is the index of the bot's cell in the chunk
+    void add(Bot& bot, const Bot::DecisionState& state, int index) noexcept;
+
+    // advances all added decisions as far as lanes can take them
+    void run(const Field& field) noexcept;
+
+    int getSize() const noexcept {
+        return static_cast<int>(m_bots.size());
+    }
+
+    Bot& getBot(int i) const noexcept {
+        return *m_bots[i];
+    }
+
+    const Bot::DecisionState& getState(int i) const noexcept {
+        return m_states[i];
+    }
+
+    int getIndex(int i) const noexcept {
+        return m_indices[i];
+    }
+private:
+    template <typename T>
+    using Lanes = std::array<T, LANES>;
+
+    // decisions in the order they were added, which is the order to finish them in
+    std::vector<Bot*> m_bots;
+    std::vector<Bot::DecisionState> m_states;
+    std::vector<int> m_indices;
+    // order of taking decisions into lanes
+    std::vector<int> m_order;
+    // genome of every decision, patched genomes are copied,
+    // as the cache of the store may evict them while lanes still read them
+    std::vector<const Species*> m_decisionGenomes;
+    std::vector<Species> m_genomeCopies;
+
+    Lanes<int> m_decisions;
+    Lanes<const Species*> m_genomes;
+    Lanes<const ControlFlow*> m_controlFlows;
+    Lanes<int> m_instructionPointers;
+    Lanes<int> m_rotations;
+    Lanes<double> m_energies;
+    Lanes<double> m_organics;
+    Lanes<int> m_executed;
+    Lanes<int> m_cycleStarts;
+    Lanes<int> m_cyclePowers;
+    Lanes<int> m_cycleLengths;
+    Lanes<int> m_cycleSteps;
+    // the bot's cell, it doesn't change until the bot eats
+    Lanes<double> m_grass;
+    Lanes<double> m_organicInCell;
+    Lanes<uint8_t> m_emptyNeighbours;
+    Lanes<uint8_t> m_occupiedNeighbours;
+
+    void collectGenomes(const Field& field);
+    void load(int lane, int decision, const Field& field) noexcept;
+    void store(int lane) noexcept;
+    void move(int from, int to) noexcept;
+
+    // executes one instruction like Bot::finishDecision,
+    // returns false without changes if the lane should retire before it
+    bool step(int lane, const Field& field) noexcept;
+    bool useInstructionsEnergy(int lane, int count, const Field& field) noexcept;
+};
+
+#endif
@@ -0,0 +1,164 @@
+/* This file is part of JCyberEvolution.
+
+JCyberEvolution is free software: you can redistribute it and/or modify it 
+under the terms of the GNU General Public License as published by the Free Software Foundation, 
+either version 3 of the License, or (at your option) any later version.
+
+JCyberEvolution is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with JCyberEvolution. 
+If not, see <https://www.gnu.org/licenses/>. */
+
+#include "Phylogeny.h"
+
+#include <vector>
+using std::vector;
+
+#include <span>
+using std::span;
+
+#include <iostream>
+using std::ostream;
+
+#include <algorithm>
+using std::copy;
+
+#include <cassert>
+
+Phylogeny::Phylogeny() noexcept : 
+    m_parents{}, m_jumps{}, m_depths{}, m_birthEpochs{}, m_extinct{}, 
+    m_mutationOffsets{0}, m_mutations{}, m_renumbering{}, m_living{} {}
+
+uint32_t Phylogeny::computeJump(uint32_t parent) const noexcept {
+    // roots have no jump, so their children jump to the root itself
+    if (parent == NONE) return NONE;
+
+    uint32_t jump = m_jumps[parent];
+    if (jump != NONE && m_jumps[jump] != NONE
+        && m_depths[parent] - m_depths[jump] == m_depths[jump] - m_depths[m_jumps[jump]])
+        return m_jumps[jump];
+    return parent;
+}
+
+uint32_t Phylogeny::add(uint32_t parent, int epoch, span<const uint8_t> mutations) {
+    uint32_t node = static_cast<uint32_t>(m_parents.size());
+    m_parents.push_back(parent);
+    m_jumps.push_back(computeJump(parent));
+    m_depths.push_back(parent == NONE ? 0 : m_depths[parent] + 1);
+    m_birthEpochs.push_back(epoch);
+    m_extinct.push_back(false);
+
+    m_mutations.insert(m_mutations.end(), mutations.begin(), mutations.end());
+    m_mutationOffsets.push_back(static_cast<uint32_t>(m_mutations.size()));
+    return node;
+}
+
+uint32_t Phylogeny::getAncestor(uint32_t node, int depth) const noexcept {
+    assert(depth >= 0 && depth <= m_depths[node]);
+
+    while (m_depths[node] > depth) {
+        uint32_t jump = m_jumps[node];
+        if (jump != NONE && m_depths[jump] >= depth) 
+            node = jump;
+        else
+            node = m_parents[node];
+    }
+    return node;
+}
+
+uint32_t Phylogeny::findCommonAncestor(uint32_t lhs, uint32_t rhs) const noexcept {
+    if (m_depths[lhs] > m_depths[rhs]) 
+        lhs = getAncestor(lhs, m_depths[rhs]);
+    else
+        rhs = getAncestor(rhs, m_depths[lhs]);
+
+    // nodes at the same depth have jumps to the same depth
+    while (lhs != rhs) {
+        if (m_jumps[lhs] != m_jumps[rhs]) {
+            lhs = m_jumps[lhs];
+            rhs = m_jumps[rhs];
+        } else {
+            lhs = m_parents[lhs];
+            rhs = m_parents[rhs];
+        }
+        if (lhs == NONE || rhs == NONE) return NONE;
+    }
+    return lhs;
+}
+
+void Phylogeny::reserve(int capacity) {
+    m_parents.reserve(capacity);
+    m_jumps.reserve(capacity);
+    m_depths.reserve(capacity);
+    m_birthEpochs.reserve(capacity);
+    m_extinct.reserve(capacity);
+    m_mutationOffsets.reserve(capacity + 1);
+    m_mutations.reserve(capacity);
+    m_renumbering.reserve(capacity);
+    m_living.reserve(capacity);
+}
+
+const vector<uint32_t>& Phylogeny::prune() {
+    int size = getSize();
+
+    // children come after parents, so one backward pass finds all living lineages
+    m_living.assign(size, false);
+    for (int node = size - 1; node >= 0; -- node) {
+        if (!m_extinct[node]) m_living[node] = true;
+        if (m_living[node] && m_parents[node] != NONE) m_living[m_parents[node]] = true;
+    }
+
+    // new numbers are never larger than old ones, so nodes and mutations move only backwards
+    // and are compacted in place
+    m_renumbering.assign(size, NONE);
+    uint32_t newSize = 0;
+    for (int node = 0; node < size; ++ node) {
+        if (!m_living[node]) continue;
+
+        uint32_t newNode = newSize ++;
+        m_renumbering[node] = newNode;
+
+        // parent was renumbered before, so its jump is already recomputed
+        uint32_t parent = m_parents[node] == NONE ? NONE : m_renumbering[m_parents[node]];
+        m_parents[newNode] = parent;
+        m_depths[newNode] = m_depths[node];
+        m_birthEpochs[newNode] = m_birthEpochs[node];
+        m_extinct[newNode] = m_extinct[node];
+        m_jumps[newNode] = computeJump(parent);
+
+        // offsets of the node are read before the offset of the new node is written over them
+        uint32_t begin = m_mutationOffsets[node];
+        uint32_t end = m_mutationOffsets[node + 1];
+        uint32_t newBegin = m_mutationOffsets[newNode];
+        copy(m_mutations.begin() + begin, m_mutations.begin() + end, m_mutations.begin() + newBegin);
+        m_mutationOffsets[newNode + 1] = newBegin + (end - begin);
+    }
+
+    m_parents.resize(newSize);
+    m_jumps.resize(newSize);
+    m_depths.resize(newSize);
+    m_birthEpochs.resize(newSize);
+    m_extinct.resize(newSize);
+    m_mutations.resize(m_mutationOffsets[newSize]);
+    m_mutationOffsets.resize(newSize + 1);
+    return m_renumbering;
+}
+
+void Phylogeny::exportCsv(ostream& os) const {
+    os << "id,parent,birth_epoch,depth,extinct,mutations\n";
+    for (uint32_t node = 0; node < m_parents.size(); ++ node) {
+        os << node << ',';
+        if (m_parents[node] != NONE) os << m_parents[node];
+        os << ',' << m_birthEpochs[node] << ',' << m_depths[node] << ',' << m_extinct[node] << ',';
+
+        bool first = true;
+        for (uint8_t position : getMutations(node)) {
+            if (!first) os << ' ';
+            os << static_cast<int>(position);
+            first = false;
+        }
+        os << '\n';
+    }
+}
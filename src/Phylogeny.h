@@ -0,0 +1,97 @@
+/* This file is part of JCyberEvolution.
+
+JCyberEvolution is free software: you can redistribute it and/or modify it 
+under the terms of the GNU General Public License as published by the Free Software Foundation, 
+either version 3 of the License, or (at your option) any later version.
+
+JCyberEvolution is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with JCyberEvolution. 
+If not, see <https://www.gnu.org/licenses/>. */
+
+#ifndef PHYLOGENY_H_
+#define PHYLOGENY_H_
+
+#include <vector>
+#include <span>
+#include <iostream>
+#include <cstdint>
+
+// append only tree of every species ever created, nodes are numbered in creation order,
+// so a parent always has a smaller number than its children
+class Phylogeny {
+public:
+    static constexpr uint32_t NONE = ~0u;
+
+    Phylogeny() noexcept;
+
+    // parent is NONE for species that didn't mutate from another one
+    uint32_t add(uint32_t parent, int epoch, std::span<const uint8_t> mutations);
+
+    void setExtinct(uint32_t node) noexcept {
+        m_extinct[node] = true;
+    }
+
+    int getSize() const noexcept {
+        return static_cast<int>(m_parents.size());
+    }
+
+    uint32_t getParent(uint32_t node) const noexcept {
+        return m_parents[node];
+    }
+
+    int getDepth(uint32_t node) const noexcept {
+        return m_depths[node];
+    }
+
+    int getBirthEpoch(uint32_t node) const noexcept {
+        return m_birthEpochs[node];
+    }
+
+    bool isExtinct(uint32_t node) const noexcept {
+        return m_extinct[node];
+    }
+
+    // genome positions changed relative to the parent
+    std::span<const uint8_t> getMutations(uint32_t node) const noexcept {
+        return {m_mutations.data() + m_mutationOffsets[node], 
+                m_mutations.data() + m_mutationOffsets[node + 1]};
+    }
+
+    // ancestor at the given depth, depth should be at most the depth of the node, O(log n)
+    uint32_t getAncestor(uint32_t node, int depth) const noexcept;
+
+    // most recent common ancestor, NONE if nodes descend from different roots, O(log n)
+    uint32_t findCommonAncestor(uint32_t lhs, uint32_t rhs) const noexcept;
+
+    // nodes added until the size reaches capacity don't allocate, 
+    // mutations are reserved for one per node
+    void reserve(int capacity);
+
+    // removes extinct nodes without living descendants and renumbers the rest in place,
+    // returns new numbers of old nodes, NONE for removed ones
+    const std::vector<uint32_t>& prune();
+
+    // one line per node: id, parent, birth epoch, depth, extinct, mutated positions
+    void exportCsv(std::ostream& os) const;
+private:
+    // jump pointers skip to ancestors at skew binary distances,
+    // so walking up to any depth takes O(log n) steps
+    std::vector<uint32_t> m_parents;
+    std::vector<uint32_t> m_jumps;
+    std::vector<int> m_depths;
+    std::vector<int> m_birthEpochs;
+    std::vector<bool> m_extinct;
+    std::vector<uint32_t> m_mutationOffsets;
+    std::vector<uint8_t> m_mutations;
+
+    // buffers of prune, kept so pruning doesn't allocate once they are large enough
+    std::vector<uint32_t> m_renumbering;
+    std::vector<bool> m_living;
+
+    uint32_t computeJump(uint32_t parent) const noexcept;
+};
+
+#endif
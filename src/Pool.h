@@ -0,0 +1,66 @@
+/* This file is part of JCyberEvolution.
+
+JCyberEvolution is free software: you can redistribute it and/or modify it 
+under the terms of the GNU General Public License as published by the Free Software Foundation, 
+either version 3 of the License, or (at your option) any later version.
+
+JCyberEvolution is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with JCyberEvolution. 
+If not, see <https://www.gnu.org/licenses/>. */
+
+#ifndef POOL_H_
+#define POOL_H_
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+#include <new>
+
+// free list of SIZE byte slots allocated BLOCK_SIZE at once and never returned to the heap,
+// so once the population stops growing objects are created without allocations,
+// not thread safe, bots are created only by the simulation thread
+template <std::size_t SIZE, std::size_t ALIGNMENT>
+class Pool {
+public:
+    static constexpr int BLOCK_SIZE = 1024;
+
+    static Pool& getInstance() noexcept {
+        static Pool pool;
+        return pool;
+    }
+
+    void* allocate() {
+        if (!m_free) grow();
+
+        Slot* slot = m_free;
+        m_free = slot->next;
+        return slot;
+    }
+
+    void deallocate(void* pointer) noexcept {
+        Slot* slot = static_cast<Slot*>(pointer);
+        slot->next = m_free;
+        m_free = slot;
+    }
+private:
+    union Slot {
+        Slot* next;
+        alignas(ALIGNMENT) std::byte storage[SIZE];
+    };
+
+    Slot* m_free = nullptr;
+    std::vector<std::unique_ptr<Slot[]>> m_blocks;
+
+    Pool() noexcept = default;
+
+    void grow() {
+        m_blocks.push_back(std::make_unique<Slot[]>(BLOCK_SIZE));
+        for (int i = BLOCK_SIZE - 1; i >= 0; -- i) 
+            deallocate(&m_blocks.back()[i]);
+    }
+};
+
+#endif
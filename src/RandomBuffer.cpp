@@ -0,0 +1,45 @@
+/* This file is part of JCyberEvolution.
+
+JCyberEvolution is free software: you can redistribute it and/or modify it 
+under the terms of the GNU General Public License as published by the Free Software Foundation, 
+either version 3 of the License, or (at your option) any later version.
+
+JCyberEvolution is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with JCyberEvolution. 
+If not, see <https://www.gnu.org/licenses/>. */
+
+#include "RandomBuffer.h"
+#include "utility.h"
+
+#include <cstdint>
+
+static uint64_t rotateLeft(uint64_t value, int shift) noexcept {
+    return value << shift | value >> (64 - shift);
+}
+
+RandomBuffer::RandomBuffer(uint64_t seed) noexcept : m_state{}, m_values{}, m_position{BLOCK_SIZE} {
+    // xoshiro states shouldn't be all zeros, SplitMix64 outputs are as recommended by its authors
+    SplitMix64 seeder{seed};
+    for (auto& word : m_state)
+        for (uint64_t& lane : word)
+            lane = seeder();
+}
+
+void RandomBuffer::refill() noexcept {
+    auto& [s0, s1, s2, s3] = m_state;
+    for (int i = 0; i < BLOCK_SIZE; i += LANES)
+        for (int lane = 0; lane < LANES; ++ lane) {
+            m_values[i + lane] = rotateLeft(s1[lane] * 5, 7) * 9;
+            uint64_t t = s1[lane] << 17;
+            s2[lane] ^= s0[lane];
+            s3[lane] ^= s1[lane];
+            s1[lane] ^= s2[lane];
+            s0[lane] ^= s3[lane];
+            s2[lane] ^= t;
+            s3[lane] = rotateLeft(s3[lane], 45);
+        }
+    m_position = 0;
+}
@@ -0,0 +1,64 @@
+/* This file is part of JCyberEvolution.
+
+JCyberEvolution is free software: you can redistribute it and/or modify it 
+under the terms of the GNU General Public License as published by the Free Software Foundation, 
+either version 3 of the License, or (at your option) any later version.
+
+JCyberEvolution is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with JCyberEvolution. 
+If not, see <https://www.gnu.org/licenses/>. */
+
+#ifndef RANDOM_BUFFER_H_
+#define RANDOM_BUFFER_H_
+
+#include <array>
+#include <cstdint>
+
+// random numbers generated in blocks by LANES interleaved xoshiro256** generators,
+// the block loop has no dependencies between lanes, so compilers can vectorize it,
+// not thread safe, every thread should have its own buffer
+class RandomBuffer {
+public:
+    static constexpr int LANES = 4;
+    static constexpr int BLOCK_SIZE = 256;
+
+    using result_type = uint64_t;
+
+    explicit RandomBuffer(uint64_t seed) noexcept;
+
+    static constexpr result_type min() noexcept {
+        return 0;
+    }
+
+    static constexpr result_type max() noexcept {
+        return UINT64_MAX;
+    }
+
+    result_type operator()() noexcept {
+        if (m_position == BLOCK_SIZE) refill();
+        return m_values[m_position ++];
+    }
+
+    // uniform in [0, range) by Lemire's multiply and shift, 
+    // rejection is needed only for ranges that aren't powers of two
+    uint32_t getBelow(uint32_t range) noexcept {
+        uint64_t product = ((*this)() >> 32) * range;
+        if (static_cast<uint32_t>(product) < range) {
+            uint32_t threshold = -range % range;
+            while (static_cast<uint32_t>(product) < threshold)
+                product = ((*this)() >> 32) * range;
+        }
+        return static_cast<uint32_t>(product >> 32);
+    }
+private:
+    std::array<std::array<uint64_t, LANES>, 4> m_state;
+    std::array<uint64_t, BLOCK_SIZE> m_values;
+    int m_position;
+
+    void refill() noexcept;
+};
+
+#endif
@@ -0,0 +1,56 @@
+/* This file is part of JCyberEvolution.
+
+JCyberEvolution is free software: you can redistribute it and/or modify it 
+under the terms of the GNU General Public License as published by the Free Software Foundation, 
+either version 3 of the License, or (at your option) any later version.
+
+JCyberEvolution is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with JCyberEvolution. 
+If not, see <https://www.gnu.org/licenses/>. */
+
+#ifndef RING_BUFFER_H_
+#define RING_BUFFER_H_
+
+#include <atomic>
+#include <memory>
+#include <cstdint>
+
+// lock free queue for one producer thread and one consumer thread,
+// counters only grow, so full and empty buffers differ
+template <typename T, int CAPACITY>
+class RingBuffer {
+public:
+    static_assert((CAPACITY & (CAPACITY - 1)) == 0, "capacity should be a power of 2");
+
+    RingBuffer() : m_values{std::make_unique<T[]>(CAPACITY)}, m_head{0}, m_tail{0} {}
+
+    // producer only, false if the buffer is full
+    bool tryPush(const T& value) noexcept {
+        uint64_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail.load(std::memory_order_acquire) == CAPACITY) return false;
+
+        m_values[head & (CAPACITY - 1)] = value;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer only, false if the buffer is empty
+    bool tryPop(T& value) noexcept {
+        uint64_t tail = m_tail.load(std::memory_order_relaxed);
+        if (tail == m_head.load(std::memory_order_acquire)) return false;
+
+        value = m_values[tail & (CAPACITY - 1)];
+        m_tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+private:
+    std::unique_ptr<T[]> m_values;
+    // counters are on separate cache lines, so threads don't invalidate each other's
+    alignas(64) std::atomic<uint64_t> m_head;
+    alignas(64) std::atomic<uint64_t> m_tail;
+};
+
+#endif
@@ -12,6 +12,8 @@ You should have received a copy of the GNU General Public License along with JCy
 If not, see <https://www.gnu.org/licenses/>. */
 
 #include "Species.h"
+#include "RandomBuffer.h"
+#include "utility.h"
 
 #include <SFML/Graphics.hpp>
 using sf::Color;
@@ -21,12 +23,6 @@ using sf::Uint32;
 #include <random>
 using std::uniform_int_distribution;
 using std::uniform_real_distribution;
-using std::mt19937_64;
-
-#include <memory>
-using std::shared_ptr;
-using std::make_shared;
-using std::enable_shared_from_this;
 
 #include <iostream>
 using std::ostream;
@@ -42,32 +38,34 @@ using std::ssize;
 
 Species::Species() noexcept : Species{Color::Black} {}
 
-Species::Species(sf::Color color) noexcept : enable_shared_from_this<Species>{}, 
-    m_color{color}, m_genome{} {}
+Species::Species(sf::Color color) noexcept : m_color{color}, m_genome{} {}
 
-shared_ptr<Species> Species::createRandom(mt19937_64& randomEngine) noexcept {
-    Color color{uniform_int_distribution<Uint32>()(randomEngine)};
+Species Species::createRandom(RandomBuffer& randomBuffer) noexcept {
+    Color color{static_cast<Uint32>(randomBuffer())};
     color.a = numeric_limits<Uint8>::max();
 
-    auto result = make_shared<Species>(color);
+    Species result{color};
 
-    uniform_int_distribution<uint16_t> genomeDistribution;
-    for (int i = 0; i < ssize(result->m_genome); ++ i) {
-        result->m_genome[i] = genomeDistribution(randomEngine);
+    // four codes from every random value
+    for (int i = 0; i < ssize(result.m_genome); i += 4) {
+        uint64_t value = randomBuffer();
+        for (int j = 0; j < 4; ++ j)
+            result.m_genome[i + j] = static_cast<uint16_t>(value >> 16 * j);
     }
     return result;
 }
 
-shared_ptr<Species> Species::createMutant(mt19937_64& randomEngine, int epoch, double mutationChance) noexcept {
-    std::shared_ptr<Species> result;
+bool Species::createMutant(SplitMix64& randomEngine, int epoch, 
+                           double mutationChance, Species& mutant) const noexcept {
+    Species* result = nullptr;
 
     uniform_int_distribution<uint16_t> genomeDistribution;
     uniform_real_distribution canonicalDistribution{0.0, 1.0};
     for (int i = 0; i < ssize(m_genome); ++ i) {
         if (canonicalDistribution(randomEngine) < mutationChance) {
             if (!result) {
-                result = make_shared<Species>(m_color);
-                result->m_genome = m_genome;
+                mutant = *this;
+                result = &mutant;
             }
 
             result->m_genome[i] = genomeDistribution(randomEngine);
@@ -95,8 +93,7 @@ shared_ptr<Species> Species::createMutant(mt19937_64& randomEngine, int epoch, d
         }
     }
 
-    if (!result) return shared_from_this();
-    return result;
+    return result != nullptr;
 }
 
 int computeDifference(const Species& lhs, const Species& rhs) noexcept {
@@ -107,6 +104,10 @@ int computeDifference(const Species& lhs, const Species& rhs) noexcept {
     return difference;
 }
 
+bool haveEqualGenomes(const Species& lhs, const Species& rhs) noexcept {
+    return lhs.m_genome == rhs.m_genome;
+}
+
 ostream& operator<< (ostream& os, const Species& species) noexcept {
     os << species.m_color.toInteger();
     for (uint16_t value : species.m_genome) {
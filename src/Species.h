@@ -14,23 +14,26 @@ If not, see <https://www.gnu.org/licenses/>. */
 #ifndef SPECIES_H_
 #define SPECIES_H_
 
+#include "RandomBuffer.h"
+#include "utility.h"
+
 #include <SFML/Graphics.hpp>
 
 #include <random>
 #include <array>
-#include <memory>
 #include <iostream>
 
-class Species : public std::enable_shared_from_this<Species> {
+// species live in the SpeciesStore, bots refer to them by handles
+class Species {
 public:
     Species() noexcept;
     explicit Species(sf::Color color) noexcept;
 
-    static std::shared_ptr<Species> createRandom(std::mt19937_64& randomEngine) noexcept;
+    static Species createRandom(RandomBuffer& randomBuffer) noexcept;
 
-    // return this if no mutation
-    std::shared_ptr<Species> createMutant(std::mt19937_64& randomEngine, 
-                                          int epoch, double mutationChance) noexcept;
+    // return false if no mutation, otherwise mutant is written
+    bool createMutant(SplitMix64& randomEngine, int epoch, 
+                      double mutationChance, Species& mutant) const noexcept;
 
     // unsafe, check index by yourself
     uint16_t& operator[] (int i) noexcept {
@@ -46,7 +49,13 @@ public:
         return m_color;
     }
 
+    void setColor(sf::Color color) noexcept {
+        m_color = color;
+    }
+
     friend int computeDifference(const Species& lhs, const Species& rhs) noexcept;
+    // stops at the first difference, unlike computeDifference
+    friend bool haveEqualGenomes(const Species& lhs, const Species& rhs) noexcept;
 
     friend std::ostream& operator<< (std::ostream& os, const Species& species) noexcept;
     friend std::istream& operator>> (std::istream& is, Species& species) noexcept;
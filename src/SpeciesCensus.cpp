@@ -0,0 +1,202 @@
+/* This file is part of JCyberEvolution.
+
+JCyberEvolution is free software: you can redistribute it and/or modify it 
+under the terms of the GNU General Public License as published by the Free Software Foundation, 
+either version 3 of the License, or (at your option) any later version.
+
+JCyberEvolution is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with JCyberEvolution. 
+If not, see <https://www.gnu.org/licenses/>. */
+
+#include "SpeciesCensus.h"
+#include "SpeciesStore.h"
+#include "BotEvent.h"
+
+#include <vector>
+using std::vector;
+using std::ssize;
+
+#include <span>
+using std::span;
+
+#include <algorithm>
+using std::max;
+using std::push_heap;
+using std::pop_heap;
+
+#include <cassert>
+
+SpeciesCensus::SpeciesCensus() noexcept : 
+    m_records{}, m_epoch{0}, m_changed{}, m_changedRecords{}, m_heap{}, m_heapPositions{}, 
+    m_rankedPopulations{}, m_candidates{} {}
+
+SpeciesCensus::Record& SpeciesCensus::getRecord(SpeciesHandle species) {
+    int index = species.getIndex();
+    if (index >= ssize(m_records)) {
+        m_records.resize(index + 1);
+        m_changed.resize(index + 1, false);
+        m_heapPositions.resize(index + 1, -1);
+        m_rankedPopulations.resize(index + 1, 0);
+    }
+
+    Record& record = m_records[index];
+    if (!(record.species == species)) {
+        // slot of an extinct species was reused, its first and last seen epochs are lost
+        assert(record.population == 0);
+        record = Record{species};
+    }
+
+    if (!m_changed[index]) {
+        m_changed[index] = true;
+        m_changedRecords.push_back(index);
+    }
+    return record;
+}
+
+void SpeciesCensus::add(SpeciesHandle species, int epoch) {
+    Record& record = getRecord(species);
+    if (record.firstSeen < 0) {
+        record.firstSeen = epoch;
+        record.lastSeen = epoch;
+    }
+    ++ record.population;
+}
+
+void SpeciesCensus::remove(SpeciesHandle species) noexcept {
+    -- getRecord(species).population;
+}
+
+void SpeciesCensus::commit(int epoch) noexcept {
+    m_epoch = epoch;
+    for (int index : m_changedRecords) {
+        m_changed[index] = false;
+
+        Record& record = m_records[index];
+        record.peak = max(record.peak, record.population);
+        if (record.population > 0) record.lastSeen = epoch;
+        m_rankedPopulations[index] = record.population;
+
+        if (record.population == 0) {
+            if (m_heapPositions[index] >= 0) removeFromHeap(index);
+        } else if (m_heapPositions[index] < 0) {
+            m_heap.push_back(index);
+            setHeapEntry(ssize(m_heap) - 1, index);
+            siftUp(ssize(m_heap) - 1);
+        } else {
+            siftUp(m_heapPositions[index]);
+            siftDown(m_heapPositions[index]);
+        }
+    }
+    m_changedRecords.clear();
+}
+
+void SpeciesCensus::handleBotEvents(span<const BotEvent> events, int epoch) {
+    for (const BotEvent& event : events) {
+        switch (event.type) {
+        case BotEvent::Type::BORN:
+            add(event.species, epoch);
+            break;
+        case BotEvent::Type::DIED:
+        case BotEvent::Type::KILLED:
+            remove(event.species);
+            break;
+        case BotEvent::Type::MOVED:
+            break;
+        }
+    }
+    commit(epoch);
+}
+
+void SpeciesCensus::clear() noexcept {
+    m_records.clear();
+    m_epoch = 0;
+    m_changed.clear();
+    m_changedRecords.clear();
+    m_heap.clear();
+    m_heapPositions.clear();
+    m_rankedPopulations.clear();
+    m_candidates.clear();
+}
+
+int SpeciesCensus::getPopulation(SpeciesHandle species) const noexcept {
+    int index = species.getIndex();
+    if (species.isNone() || index >= ssize(m_records) || !(m_records[index].species == species)) 
+        return 0;
+    return m_records[index].population;
+}
+
+void SpeciesCensus::findLargest(int count, vector<Record>& largest) const {
+    largest.clear();
+    if (m_heap.empty()) return;
+
+    // heap positions of candidates, children of taken records become candidates
+    m_candidates.assign(1, 0);
+    auto compare = [this] (int lhs, int rhs) {
+        return isGreater(m_heap[rhs], m_heap[lhs]);
+    };
+    while (ssize(largest) < count && !m_candidates.empty()) {
+        pop_heap(m_candidates.begin(), m_candidates.end(), compare);
+        int position = m_candidates.back();
+        m_candidates.pop_back();
+        largest.push_back(m_records[m_heap[position]]);
+        largest.back().lastSeen = m_epoch;
+
+        for (int child = 2 * position + 1; child <= 2 * position + 2; ++ child)
+            if (child < ssize(m_heap)) {
+                m_candidates.push_back(child);
+                push_heap(m_candidates.begin(), m_candidates.end(), compare);
+            }
+    }
+}
+
+bool SpeciesCensus::isGreater(int lhs, int rhs) const noexcept {
+    // ties are broken by handles, so the order doesn't depend on the history of the heap
+    if (m_rankedPopulations[lhs] != m_rankedPopulations[rhs])
+        return m_rankedPopulations[lhs] > m_rankedPopulations[rhs];
+    return m_records[lhs].species.getValue() < m_records[rhs].species.getValue();
+}
+
+void SpeciesCensus::setHeapEntry(int position, int record) noexcept {
+    m_heap[position] = record;
+    m_heapPositions[record] = position;
+}
+
+void SpeciesCensus::siftUp(int position) noexcept {
+    int record = m_heap[position];
+    while (position > 0) {
+        int parent = (position - 1) / 2;
+        if (!isGreater(record, m_heap[parent])) break;
+        setHeapEntry(position, m_heap[parent]);
+        position = parent;
+    }
+    setHeapEntry(position, record);
+}
+
+void SpeciesCensus::siftDown(int position) noexcept {
+    int record = m_heap[position];
+    while (true) {
+        int child = 2 * position + 1;
+        if (child >= ssize(m_heap)) break;
+        if (child + 1 < ssize(m_heap) && isGreater(m_heap[child + 1], m_heap[child])) ++ child;
+        if (!isGreater(m_heap[child], record)) break;
+        setHeapEntry(position, m_heap[child]);
+        position = child;
+    }
+    setHeapEntry(position, record);
+}
+
+void SpeciesCensus::removeFromHeap(int record) noexcept {
+    int position = m_heapPositions[record];
+    m_heapPositions[record] = -1;
+
+    int last = m_heap.back();
+    m_heap.pop_back();
+    if (position == ssize(m_heap)) return;
+
+    setHeapEntry(position, last);
+    siftUp(position);
+    siftDown(m_heapPositions[last]);
+}
@@ -0,0 +1,78 @@
+/* This file is part of JCyberEvolution.
+
+JCyberEvolution is free software: you can redistribute it and/or modify it 
+under the terms of the GNU General Public License as published by the Free Software Foundation, 
+either version 3 of the License, or (at your option) any later version.
+
+JCyberEvolution is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with JCyberEvolution. 
+If not, see <https://www.gnu.org/licenses/>. */
+
+#ifndef SPECIES_CENSUS_H_
+#define SPECIES_CENSUS_H_
+
+#include "SpeciesStore.h"
+#include "BotEvent.h"
+
+#include <vector>
+#include <span>
+
+// bots of every species counted on every birth and death instead of scanning the field,
+// species are ranked by population in a heap updated only for species that changed,
+// only living species are covered, the record of an extinct one is dropped when its slot is reused
+class SpeciesCensus : public BotEventObserver {
+public:
+    struct Record {
+        SpeciesHandle species;
+        int population = 0;
+        int peak = 0;
+        int firstSeen = -1;
+        // epoch of the last commit for living species
+        int lastSeen = -1;
+    };
+
+    SpeciesCensus() noexcept;
+
+    void add(SpeciesHandle species, int epoch);
+
+    void remove(SpeciesHandle species) noexcept;
+
+    // updates peaks, last seen epochs and the ranking of species changed since the last commit
+    void commit(int epoch) noexcept;
+
+    // counts births and deaths, then commits
+    void handleBotEvents(std::span<const BotEvent> events, int epoch) override;
+
+    void clear() noexcept;
+
+    int getPopulation(SpeciesHandle species) const noexcept;
+
+    // up to count living species with the largest population, O(count log count)
+    void findLargest(int count, std::vector<Record>& largest) const;
+private:
+    std::vector<Record> m_records;
+    int m_epoch;
+    std::vector<bool> m_changed;
+    std::vector<int> m_changedRecords;
+
+    // max heap of records by population, -1 position for records outside of it,
+    // the heap orders populations from commits, so pending changes don't break it
+    std::vector<int> m_heap;
+    std::vector<int> m_heapPositions;
+    std::vector<int> m_rankedPopulations;
+    // heap positions taken into account by findLargest, kept so it doesn't allocate
+    mutable std::vector<int> m_candidates;
+
+    Record& getRecord(SpeciesHandle species);
+
+    bool isGreater(int lhs, int rhs) const noexcept;
+    void setHeapEntry(int position, int record) noexcept;
+    void siftUp(int position) noexcept;
+    void siftDown(int position) noexcept;
+    void removeFromHeap(int record) noexcept;
+};
+
+#endif
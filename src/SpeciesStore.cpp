@@ -0,0 +1,262 @@
+/* This file is part of JCyberEvolution.
+
+JCyberEvolution is free software: you can redistribute it and/or modify it 
+under the terms of the GNU General Public License as published by the Free Software Foundation, 
+either version 3 of the License, or (at your option) any later version.
+
+JCyberEvolution is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with JCyberEvolution. 
+If not, see <https://www.gnu.org/licenses/>. */
+
+#include "SpeciesStore.h"
+#include "Species.h"
+#include "Phylogeny.h"
+
+#include <memory>
+using std::make_unique;
+
+#include <mutex>
+using std::scoped_lock;
+
+#include <array>
+using std::array;
+
+#include <vector>
+using std::vector;
+
+#include <span>
+using std::span;
+
+#include <iostream>
+using std::ostream;
+
+#include <algorithm>
+using std::max;
+
+#include <cassert>
+
+SpeciesStore::SpeciesStore() : 
+    m_blocks{}, m_controlFlowBlocks{}, m_size{0}, m_free{}, m_aliveCount{0}, m_mutex{}, 
+    m_genomeBlocks{}, m_genomeCount{0}, m_freeGenomes{}, m_patchedCount{0}, m_deltaGenomes{false}, 
+    m_cache{}, m_cacheHead{-1}, m_cacheTail{-1}, 
+    m_epoch{0}, m_phylogeny{}, m_prunedPhylogenySize{0} {
+    reservePhylogeny();
+}
+
+SpeciesHandle SpeciesStore::create(const Species& species, SpeciesHandle parent, 
+                                   const ControlFlow& controlFlow) {
+    // the parent is read under the lock too, other threads may be creating species
+    scoped_lock lock{m_mutex};
+
+    // genome positions that differ from the parent
+    array<uint8_t, 256> mutations;
+    int mutationCount = 0;
+    uint32_t parentNode = Phylogeny::NONE;
+    if (!parent.isNone()) {
+        const Species& parentSpecies = (*this)[parent];
+        parentNode = getSlot(parent.getIndex()).node;
+        for (int i = 0; i < 256; ++ i)
+            if (parentSpecies[i] != species[i])
+                mutations[mutationCount ++] = static_cast<uint8_t>(i);
+    }
+
+    int index;
+    if (!m_free.empty()) {
+        index = m_free.back();
+        m_free.pop_back();
+    } else {
+        index = m_size ++;
+        assert(index <= static_cast<int>(SpeciesHandle::INDEX_MASK));
+        if (!m_blocks[index >> BLOCK_BITS]) {
+            m_blocks[index >> BLOCK_BITS] = make_unique<Slot[]>(BLOCK_SIZE);
+            m_controlFlowBlocks[index >> BLOCK_BITS] = make_unique<ControlFlow[]>(BLOCK_SIZE);
+        }
+    }
+    m_controlFlowBlocks[index >> BLOCK_BITS][index & (BLOCK_SIZE - 1)] = controlFlow;
+
+    Slot& slot = getSlot(index);
+    slot.color = species.getColor();
+    Slot* parentSlot = parent.isNone() ? nullptr : &getSlot(parent.getIndex());
+    if (m_deltaGenomes && parentSlot && mutationCount <= MAX_PATCH_SIZE 
+            && parentSlot->depth < MAX_PATCH_DEPTH) {
+        slot.base = parent.getIndex();
+        slot.depth = parentSlot->depth + 1;
+        slot.patchSize = static_cast<uint8_t>(mutationCount);
+        for (int i = 0; i < mutationCount; ++ i)
+            slot.patch[i] = {mutations[i], species[mutations[i]]};
+        ++ parentSlot->dependents;
+        ++ m_patchedCount;
+    } else {
+        // too deep chains are rebased on a full copy
+        slot.genome = allocateGenome(species);
+        slot.depth = 0;
+    }
+    slot.alive = true;
+    slot.extinct = false;
+    slot.references = 0;
+    slot.pins = 0;
+    slot.dependents = 0;
+    slot.node = m_phylogeny.add(parentNode, m_epoch, span{mutations.data(), 
+                                                          static_cast<size_t>(mutationCount)});
+    ++ m_aliveCount;
+    return SpeciesHandle{index, slot.generation};
+}
+
+uint32_t SpeciesStore::allocateGenome(const Species& species) {
+    uint32_t genome;
+    if (!m_freeGenomes.empty()) {
+        genome = m_freeGenomes.back();
+        m_freeGenomes.pop_back();
+    } else {
+        genome = m_genomeCount ++;
+        if (!m_genomeBlocks[genome >> BLOCK_BITS]) 
+            m_genomeBlocks[genome >> BLOCK_BITS] = make_unique<Species[]>(BLOCK_SIZE);
+    }
+    getGenome(genome) = species;
+    return genome;
+}
+
+void SpeciesStore::setDeltaGenomes(bool deltaGenomes) {
+    m_deltaGenomes = deltaGenomes;
+    if (!deltaGenomes || !m_cache.empty()) return;
+
+    m_cache.resize(CACHE_SIZE);
+    for (int entry = 0; entry < CACHE_SIZE; ++ entry) {
+        m_cache[entry].previous = entry - 1;
+        m_cache[entry].next = entry + 1 < CACHE_SIZE ? entry + 1 : -1;
+    }
+    m_cacheHead = 0;
+    m_cacheTail = CACHE_SIZE - 1;
+}
+
+const Species& SpeciesStore::materializePatch(int index) const noexcept {
+    const Slot& slot = getSlot(index);
+    if (slot.cacheEntry >= 0) {
+        touchCacheEntry(slot.cacheEntry);
+        return m_cache[slot.cacheEntry].species;
+    }
+
+    // base is touched first, so it isn't the evicted tail
+    const Species& base = materialize(slot.base);
+    int entry = m_cacheTail;
+    CacheEntry& cached = m_cache[entry];
+    if (cached.slot >= 0) getSlot(cached.slot).cacheEntry = -1;
+
+    cached.species = base;
+    cached.species.setColor(slot.color);
+    for (int i = 0; i < slot.patchSize; ++ i)
+        cached.species[slot.patch[i].position] = slot.patch[i].value;
+    cached.slot = index;
+    slot.cacheEntry = entry;
+    touchCacheEntry(entry);
+    return cached.species;
+}
+
+void SpeciesStore::touchCacheEntry(int entry) const noexcept {
+    if (entry == m_cacheHead) return;
+
+    CacheEntry& cached = m_cache[entry];
+    m_cache[cached.previous].next = cached.next;
+    if (cached.next >= 0) m_cache[cached.next].previous = cached.previous;
+    else m_cacheTail = cached.previous;
+
+    cached.previous = -1;
+    cached.next = m_cacheHead;
+    m_cache[m_cacheHead].previous = entry;
+    m_cacheHead = entry;
+}
+
+void SpeciesStore::createMutants(span<Mutant> mutants) {
+    for (Mutant& mutant : mutants)
+        mutant.handle = mutant.mutated ? create(mutant.species, mutant.parent) : mutant.parent;
+}
+
+bool SpeciesStore::isAlive(SpeciesHandle handle) const noexcept {
+    if (handle.isNone() || handle.getIndex() >= m_size) return false;
+
+    const Slot& slot = getSlot(handle.getIndex());
+    return slot.alive && !slot.extinct && slot.generation == handle.getGeneration();
+}
+
+void SpeciesStore::pin(SpeciesHandle handle) noexcept {
+    if (isAlive(handle)) ++ getSlot(handle.getIndex()).pins;
+}
+
+void SpeciesStore::unpin(SpeciesHandle handle) noexcept {
+    if (isAlive(handle)) -- getSlot(handle.getIndex()).pins;
+}
+
+void SpeciesStore::beginCollection() noexcept {
+    for (int index = 0; index < m_size; ++ index)
+        getSlot(index).references = 0;
+}
+
+int SpeciesStore::endCollection() noexcept {
+    int collected = 0;
+    for (int index = 0; index < m_size; ++ index) {
+        Slot& slot = getSlot(index);
+        if (!slot.alive || slot.extinct || slot.references > 0 || slot.pins > 0) continue;
+
+        slot.extinct = true;
+        m_phylogeny.setExtinct(slot.node);
+        if (slot.dependents == 0) release(index);
+        ++ collected;
+    }
+    m_aliveCount -= collected;
+
+    if (m_phylogeny.getSize() > 2 * max(m_prunedPhylogenySize, MIN_PRUNED_PHYLOGENY_SIZE))
+        prunePhylogeny();
+    return collected;
+}
+
+void SpeciesStore::release(int index) noexcept {
+    while (true) {
+        Slot& slot = getSlot(index);
+        if (slot.genome != NO_GENOME) {
+            m_freeGenomes.push_back(slot.genome);
+            slot.genome = NO_GENOME;
+        } else {
+            -- m_patchedCount;
+        }
+        if (slot.cacheEntry >= 0) {
+            m_cache[slot.cacheEntry].slot = -1;
+            slot.cacheEntry = -1;
+        }
+        slot.alive = false;
+        slot.extinct = false;
+        ++ slot.generation;
+        m_free.push_back(index);
+
+        int base = slot.base;
+        slot.base = -1;
+        if (base < 0) return;
+
+        // extinct base is kept only while it has dependents
+        Slot& baseSlot = getSlot(base);
+        if (-- baseSlot.dependents > 0 || !baseSlot.extinct) return;
+        index = base;
+    }
+}
+
+void SpeciesStore::prunePhylogeny() {
+    const vector<uint32_t>& renumbering = m_phylogeny.prune();
+    for (int index = 0; index < m_size; ++ index) {
+        Slot& slot = getSlot(index);
+        if (slot.alive && slot.node != Phylogeny::NONE) slot.node = renumbering[slot.node];
+    }
+    m_prunedPhylogenySize = m_phylogeny.getSize();
+    reservePhylogeny();
+}
+
+void SpeciesStore::reservePhylogeny() {
+    int pruningSize = 2 * max(m_prunedPhylogenySize, MIN_PRUNED_PHYLOGENY_SIZE);
+    m_phylogeny.reserve(pruningSize + pruningSize / PHYLOGENY_SLACK_DIVISOR);
+}
+
+void SpeciesStore::exportPhylogeny(ostream& os) {
+    prunePhylogeny();
+    m_phylogeny.exportCsv(os);
+}
@@ -0,0 +1,288 @@
+/* This file is part of JCyberEvolution.
+
+JCyberEvolution is free software: you can redistribute it and/or modify it 
+under the terms of the GNU General Public License as published by the Free Software Foundation, 
+either version 3 of the License, or (at your option) any later version.
+
+JCyberEvolution is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with JCyberEvolution. 
+If not, see <https://www.gnu.org/licenses/>. */
+
+#ifndef SPECIES_STORE_H_
+#define SPECIES_STORE_H_
+
+#include "Species.h"
+#include "Phylogeny.h"
+#include "ControlFlow.h"
+#include "RandomBuffer.h"
+
+#include <array>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <iostream>
+#include <cstdint>
+
+// index of a slot in the SpeciesStore and generation of the slot,
+// generation changes when the slot is reused, so handles of collected species become stale
+class SpeciesHandle {
+public:
+    static constexpr int INDEX_BITS = 24;
+    static constexpr uint32_t INDEX_MASK = (1u << INDEX_BITS) - 1;
+
+    SpeciesHandle() noexcept : m_value{NONE} {}
+
+    SpeciesHandle(int index, int generation) noexcept : 
+        m_value{static_cast<uint32_t>(generation) << INDEX_BITS | static_cast<uint32_t>(index)} {}
+
+    int getIndex() const noexcept {
+        return m_value & INDEX_MASK;
+    }
+
+    int getGeneration() const noexcept {
+        return m_value >> INDEX_BITS;
+    }
+
+    bool isNone() const noexcept {
+        return m_value == NONE;
+    }
+
+    uint32_t getValue() const noexcept {
+        return m_value;
+    }
+
+    friend bool operator== (SpeciesHandle lhs, SpeciesHandle rhs) noexcept = default;
+private:
+    static constexpr uint32_t NONE = ~0u;
+
+    uint32_t m_value;
+};
+
+// species of the bots of a field stored in blocks of contiguous slots that never move,
+// species without bots are collected by mark and sweep at the end of epochs,
+// genomes are stored in full or, in delta mode, as small patches against the parent,
+// every field owns its store, handles are meaningful only in the store that created them
+class SpeciesStore {
+public:
+    SpeciesStore();
+
+    SpeciesStore(const SpeciesStore&) = delete;
+    SpeciesStore& operator= (const SpeciesStore&) = delete;
+
+    // thread safe unless in delta mode, where lookups of other threads change the genome cache,
+    // other methods aren't
+    SpeciesHandle create(const Species& species) {
+        return create(species, SpeciesHandle{});
+    }
+
+    // control flow analysed beforehand, possibly in parallel
+    SpeciesHandle create(const Species& species, const ControlFlow& controlFlow) {
+        return create(species, SpeciesHandle{}, controlFlow);
+    }
+
+    SpeciesHandle createRandom(RandomBuffer& randomBuffer) {
+        return create(Species::createRandom(randomBuffer));
+    }
+
+    // offspring genome mutated outside of the store, possibly in parallel
+    struct Mutant {
+        SpeciesHandle parent;
+        // copy of the parent's genome until it mutates
+        Species species;
+        bool mutated = false;
+        // species of the offspring, parent if it didn't mutate
+        SpeciesHandle handle;
+    };
+
+    // creates species of mutated ones in order, so handles don't depend on the threads
+    void createMutants(std::span<Mutant> mutants);
+
+    // unsafe, handle should be alive,
+    // patched genomes are materialized in a cache, so the reference stays valid
+    // only during the next CACHE_SIZE - 1 lookups
+    const Species& operator[] (SpeciesHandle handle) const noexcept {
+        return materialize(handle.getIndex());
+    }
+
+    // genomes stored in full keep their address while the species is alive,
+    // patched ones live in the cache and have to be copied to be kept for longer
+    bool isPatched(SpeciesHandle handle) const noexcept {
+        return getSlot(handle.getIndex()).genome == NO_GENOME;
+    }
+
+    // unsafe, handle should be alive, analysed once when the species is created
+    const ControlFlow& getControlFlow(SpeciesHandle handle) const noexcept {
+        int index = handle.getIndex();
+        return m_controlFlowBlocks[index >> BLOCK_BITS][index & (BLOCK_SIZE - 1)];
+    }
+
+    bool isAlive(SpeciesHandle handle) const noexcept;
+
+    // pinned species aren't collected even without bots, for bots outside of the field
+    void pin(SpeciesHandle handle) noexcept;
+    void unpin(SpeciesHandle handle) noexcept;
+
+    // counts bots of every species, marking them alive
+    void beginCollection() noexcept;
+
+    void mark(SpeciesHandle handle) noexcept {
+        ++ getSlot(handle.getIndex()).references;
+    }
+
+    // frees species that weren't marked or pinned, returns their number
+    int endCollection() noexcept;
+
+    // bots of the species found by the last collection
+    int getReferences(SpeciesHandle handle) const noexcept {
+        return getSlot(handle.getIndex()).references;
+    }
+
+    int getAliveCount() const noexcept {
+        return m_aliveCount;
+    }
+
+    // new mutants with few mutations are stored as patches against their parent
+    void setDeltaGenomes(bool deltaGenomes);
+
+    // full genomes include bases of patches whose species are extinct
+    int getFullGenomeCount() const noexcept {
+        return m_genomeCount - static_cast<int>(m_freeGenomes.size());
+    }
+
+    int getPatchedGenomeCount() const noexcept {
+        return m_patchedCount;
+    }
+
+    // birth epoch of species created from now on
+    void setEpoch(int epoch) noexcept {
+        m_epoch = epoch;
+    }
+
+    const Phylogeny& getPhylogeny() const noexcept {
+        return m_phylogeny;
+    }
+
+    // node of the species in the phylogeny, changes when extinct branches are pruned
+    uint32_t getPhylogenyNode(SpeciesHandle handle) const noexcept {
+        return getSlot(handle.getIndex()).node;
+    }
+
+    // prunes extinct branches first, so only ancestors of living species are written
+    void exportPhylogeny(std::ostream& os);
+
+    static constexpr int CACHE_SIZE = 4096;
+private:
+    static constexpr int BLOCK_BITS = 12;
+    static constexpr int BLOCK_SIZE = 1 << BLOCK_BITS;
+    static constexpr int MAX_BLOCKS = 1 << (SpeciesHandle::INDEX_BITS - BLOCK_BITS);
+
+    static constexpr int MAX_PATCH_SIZE = 6;
+    // longer chains are rebased, the genome is stored in full
+    static constexpr int MAX_PATCH_DEPTH = 8;
+    static constexpr uint32_t NO_GENOME = ~0u;
+
+    struct Patch {
+        uint8_t position;
+        uint16_t value;
+    };
+
+    struct Slot {
+        sf::Color color;
+        // index in the genome pool, NO_GENOME if the genome is a patch against the base
+        uint32_t genome = NO_GENOME;
+        int base = -1;
+        uint8_t depth = 0;
+        uint8_t patchSize = 0;
+        std::array<Patch, MAX_PATCH_SIZE> patch;
+        uint8_t generation = 0;
+        bool alive = false;
+        // no bots, kept only as a base of other patches
+        bool extinct = false;
+        int references = 0;
+        int pins = 0;
+        // patches applied to this species
+        int dependents = 0;
+        uint32_t node = Phylogeny::NONE;
+        mutable int cacheEntry = -1;
+    };
+
+    // intrusive LRU list of materialized patched genomes
+    struct CacheEntry {
+        Species species;
+        int slot = -1;
+        int previous = -1;
+        int next = -1;
+    };
+
+    // blocks are allocated on demand and never move, so reading doesn't need the lock
+    std::array<std::unique_ptr<Slot[]>, MAX_BLOCKS> m_blocks;
+    // parallel to slots, kept apart so the collection doesn't walk over them
+    std::array<std::unique_ptr<ControlFlow[]>, MAX_BLOCKS> m_controlFlowBlocks;
+    int m_size;
+    std::vector<int> m_free;
+    int m_aliveCount;
+    std::mutex m_mutex;
+
+    std::array<std::unique_ptr<Species[]>, MAX_BLOCKS> m_genomeBlocks;
+    int m_genomeCount;
+    std::vector<uint32_t> m_freeGenomes;
+    int m_patchedCount;
+    bool m_deltaGenomes;
+
+    mutable std::vector<CacheEntry> m_cache;
+    mutable int m_cacheHead;
+    mutable int m_cacheTail;
+
+    int m_epoch;
+    Phylogeny m_phylogeny;
+    // phylogeny is pruned when it grows twice since the last pruning
+    int m_prunedPhylogenySize;
+    static constexpr int MIN_PRUNED_PHYLOGENY_SIZE = 1 << 16;
+    // nodes reserved beyond the pruning size for species created in the epoch it is exceeded
+    static constexpr int PHYLOGENY_SLACK_DIVISOR = 16;
+
+    SpeciesHandle create(const Species& species, SpeciesHandle parent) {
+        return create(species, parent, ControlFlow{species});
+    }
+
+    SpeciesHandle create(const Species& species, SpeciesHandle parent, 
+                         const ControlFlow& controlFlow);
+    void prunePhylogeny();
+    // species are created without allocations until the phylogeny is pruned
+    void reservePhylogeny();
+
+    uint32_t allocateGenome(const Species& species);
+    // frees the slot and bases that are no longer needed
+    void release(int index) noexcept;
+
+    const Species& materialize(int index) const noexcept {
+        const Slot& slot = getSlot(index);
+        if (slot.genome != NO_GENOME) [[likely]] return getGenome(slot.genome);
+        return materializePatch(index);
+    }
+
+    const Species& materializePatch(int index) const noexcept;
+    void touchCacheEntry(int entry) const noexcept;
+
+    Species& getGenome(uint32_t genome) noexcept {
+        return m_genomeBlocks[genome >> BLOCK_BITS][genome & (BLOCK_SIZE - 1)];
+    }
+
+    const Species& getGenome(uint32_t genome) const noexcept {
+        return m_genomeBlocks[genome >> BLOCK_BITS][genome & (BLOCK_SIZE - 1)];
+    }
+
+    Slot& getSlot(int index) noexcept {
+        return m_blocks[index >> BLOCK_BITS][index & (BLOCK_SIZE - 1)];
+    }
+
+    const Slot& getSlot(int index) const noexcept {
+        return m_blocks[index >> BLOCK_BITS][index & (BLOCK_SIZE - 1)];
+    }
+};
+
+#endif
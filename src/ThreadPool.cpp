@@ -0,0 +1,113 @@
+/* This file is part of JCyberEvolution.
+
+JCyberEvolution is free software: you can redistribute it and/or modify it 
+under the terms of the GNU General Public License as published by the Free Software Foundation, 
+either version 3 of the License, or (at your option) any later version.
+
+JCyberEvolution is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with JCyberEvolution. 
+If not, see <https://www.gnu.org/licenses/>. */
+
+#include "ThreadPool.h"
+
+#include <vector>
+using std::vector;
+
+#include <thread>
+using std::thread;
+
+#include <mutex>
+using std::mutex;
+using std::scoped_lock;
+using std::unique_lock;
+
+#include <algorithm>
+using std::max;
+
+#include <exception>
+using std::exception_ptr;
+using std::current_exception;
+using std::rethrow_exception;
+
+#include <utility>
+using std::exchange;
+
+ThreadPool::ThreadPool() : ThreadPool(max(static_cast<int>(thread::hardware_concurrency()) - 1, 0)) {}
+
+ThreadPool::ThreadPool(int workerCount) : 
+        m_workers{}, m_mutex{}, m_wake{}, m_done{}, m_call{nullptr}, m_task{nullptr}, 
+        m_count{0}, m_next{0}, m_busy{0}, m_pass{0}, m_stopping{false}, 
+        m_exception{} {
+    m_workers.reserve(workerCount);
+    for (int i = 0; i < workerCount; ++ i)
+        m_workers.emplace_back(&ThreadPool::work, this);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        scoped_lock lock{m_mutex};
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    for (thread& worker : m_workers)
+        worker.join();
+}
+
+void ThreadPool::dispatch(int count) {
+    // waking workers costs more than a single call
+    if (m_workers.empty() || count <= 1) {
+        for (int i = 0; i < count; ++ i)
+            m_call(m_task, i);
+        return;
+    }
+
+    {
+        scoped_lock lock{m_mutex};
+        m_count = count;
+        m_next.store(0, std::memory_order_relaxed);
+        m_busy = static_cast<int>(m_workers.size());
+        ++ m_pass;
+    }
+    m_wake.notify_all();
+    callTasks();
+
+    exception_ptr exception;
+    {
+        unique_lock lock{m_mutex};
+        m_done.wait(lock, [this] { return m_busy == 0; });
+        exception = exchange(m_exception, nullptr);
+    }
+    if (exception) rethrow_exception(exception);
+}
+
+void ThreadPool::work() noexcept {
+    uint64_t pass = 0;
+    while (true) {
+        {
+            unique_lock lock{m_mutex};
+            m_wake.wait(lock, [this, pass] { return m_stopping || m_pass != pass; });
+            if (m_stopping) return;
+            pass = m_pass;
+        }
+        callTasks();
+
+        scoped_lock lock{m_mutex};
+        if (-- m_busy == 0) m_done.notify_one();
+    }
+}
+
+void ThreadPool::callTasks() noexcept {
+    int i;
+    while ((i = m_next.fetch_add(1, std::memory_order_relaxed)) < m_count) {
+        try {
+            m_call(m_task, i);
+        } catch (...) {
+            scoped_lock lock{m_mutex};
+            if (!m_exception) m_exception = current_exception();
+            m_next.store(m_count, std::memory_order_relaxed);
+        }
+    }
+}
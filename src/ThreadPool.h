@@ -0,0 +1,76 @@
+/* This file is part of JCyberEvolution.
+
+JCyberEvolution is free software: you can redistribute it and/or modify it 
+under the terms of the GNU General Public License as published by the Free Software Foundation, 
+either version 3 of the License, or (at your option) any later version.
+
+JCyberEvolution is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with JCyberEvolution. 
+If not, see <https://www.gnu.org/licenses/>. */
+
+#ifndef THREAD_POOL_H_
+#define THREAD_POOL_H_
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <exception>
+#include <type_traits>
+#include <cstdint>
+
+// workers started once and woken for every parallel pass, so passes of an epoch don't allocate,
+// tasks are indices taken one by one, the calling thread takes them too
+class ThreadPool {
+public:
+    // one thread per hardware thread, the calling one included
+    ThreadPool();
+    explicit ThreadPool(int workerCount);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator= (const ThreadPool&) = delete;
+
+    int getThreadCount() const noexcept {
+        return static_cast<int>(m_workers.size()) + 1;
+    }
+
+    // calls task(i) for every i in [0, count) and returns when all calls are done,
+    // results shouldn't depend on the thread that runs a call,
+    // if a call throws, the rest are skipped and the first exception is rethrown here
+    template <typename Task>
+    void run(int count, Task&& task) {
+        m_call = [] (void* task, int i) {
+            (*static_cast<std::remove_reference_t<Task>*>(task))(i);
+        };
+        m_task = &task;
+        dispatch(count);
+    }
+private:
+    std::vector<std::thread> m_workers;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+
+    void (*m_call)(void* task, int i);
+    void* m_task;
+    int m_count;
+    std::atomic<int> m_next;
+    // workers that haven't finished the current pass
+    int m_busy;
+    // counts passes, so a worker doesn't take part in one twice
+    uint64_t m_pass;
+    bool m_stopping;
+    // first exception thrown by a call of the current pass
+    std::exception_ptr m_exception;
+
+    void dispatch(int count);
+    void work() noexcept;
+    void callTasks() noexcept;
+};
+
+#endif
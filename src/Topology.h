@@ -47,13 +47,12 @@ public:
     virtual Id getId() const = 0;
 
     static void showCombo(int fieldWidth, int fieldHeight, std::unique_ptr<Topology>& fieldTopology);
+    static std::unique_ptr<Topology> createTopology(Id id, int width, int height);
 protected:
     int m_width;
     int m_height;
 
     virtual bool do_makeIndicesSafe(int& x, int& y, int& rotation) const = 0;
-private:
-    static std::unique_ptr<Topology> createTopology(Id id, int width, int height);
 };
 
 #endif
@@ -19,6 +19,8 @@ If not, see <https://www.gnu.org/licenses/>. */
 #include <cmath>
 using std::abs;
 
+#include <cstdint>
+
 sf::Color getOutlineColorFor(sf::Color color) noexcept;
 
 sf::Vector2i getOffsetForRotation(int rotation) noexcept;
@@ -31,6 +33,48 @@ inline int getOppositeRotation(int rotation) noexcept {
     return (rotation + 4) % 8;
 }
 
+// in fixed point mode all energy is a multiple of ENERGY_UNIT,
+// so sums of it are exact and don't depend on the order
+const double ENERGY_UNIT = 1.0 / 65536;
+
+// rounds toward zero, so quantized opposite transfers stay exactly opposite
+inline double quantizeEnergy(double energy) noexcept {
+    return std::trunc(energy / ENERGY_UNIT) * ENERGY_UNIT;
+}
+
+// SplitMix64 output function, turns consecutive keys into independent looking values
+inline uint64_t splitMix64(uint64_t key) noexcept {
+    key += 0x9E3779B97F4A7C15;
+    key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9;
+    key = (key ^ (key >> 27)) * 0x94D049BB133111EB;
+    return key ^ (key >> 31);
+}
+
+// SplitMix64 generator for <random> distributions, seeding is free,
+// so every task of a parallel pass can have its own deterministic stream
+class SplitMix64 {
+public:
+    using result_type = uint64_t;
+
+    explicit SplitMix64(uint64_t seed) noexcept : m_state{seed} {}
+
+    static constexpr result_type min() noexcept {
+        return 0;
+    }
+
+    static constexpr result_type max() noexcept {
+        return UINT64_MAX;
+    }
+
+    result_type operator()() noexcept {
+        uint64_t result = splitMix64(m_state);
+        m_state += 0x9E3779B97F4A7C15;
+        return result;
+    }
+private:
+    uint64_t m_state;
+};
+
 template <typename T>
 decltype(auto) containerGetter(void* container, int index) noexcept {
     return (*static_cast<T*>(container))[index];
@@ -0,0 +1,136 @@
+/* This file is part of JCyberEvolution.
+
+JCyberEvolution is free software: you can redistribute it and/or modify it 
+under the terms of the GNU General Public License as published by the Free Software Foundation, 
+either version 3 of the License, or (at your option) any later version.
+
+JCyberEvolution is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; 
+without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+See the GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License along with JCyberEvolution. 
+If not, see <https://www.gnu.org/licenses/>. */
+
+
+// checks that epochs of a settled field don't make heap allocations, mutations included,
+// every configuration should run in its own process, ctest runs them so,
+// with frequent mutations the species store still grows in amortised steps, so it is checked
+// against a bound, but epochs that prune the phylogeny shouldn't allocate at all
+
+#include "Field.h"
+#include "Topology.h"
+#include "AllocationCounter.h"
+
+#include <iostream>
+using std::cout;
+using std::cerr;
+using std::endl;
+
+#include <functional>
+using std::function;
+
+#include <string_view>
+using std::string_view;
+
+#include <cstdlib>
+#include <cstdint>
+
+static constexpr uint64_t SEED = 1;
+
+struct Configuration {
+    const char* name;
+    int fieldSize;
+    int warmUpEpochs;
+    int checkedEpochs;
+    // allocations allowed in the checked epochs together, epochs that prune don't count
+    uint64_t maxAllocations;
+    // the checked epochs should prune the phylogeny at least once
+    bool prunes;
+    function<void(Field::Settings&)> configure;
+};
+
+static const Configuration CONFIGURATIONS[] = {
+    {"default", 64, 1000, 1000, 0, false, [] (Field::Settings&) {}},
+    {"memoized", 64, 1000, 1000, 0, false, [] (Field::Settings& settings) {
+        settings.memoizeDecisions = true;
+    }},
+    {"lockstep", 64, 1000, 1000, 0, false, [] (Field::Settings& settings) {
+        settings.lockstepDecisions = true;
+    }},
+    {"fixed-point", 64, 1000, 1000, 0, false, [] (Field::Settings& settings) {
+        settings.fixedPointEnergy = true;
+    }},
+    {"frequent-mutations", 128, 400, 600, 16, true, [] (Field::Settings& settings) {
+        settings.mutationChance = 0.01f;
+    }},
+};
+
+static bool check(const Configuration& configuration) {
+    Field field{configuration.fieldSize, configuration.fieldSize, SEED};
+    field.setTopology(Topology::createTopology(Topology::Id::TORUS, 
+                                               configuration.fieldSize, configuration.fieldSize));
+    configuration.configure(field.getSettings());
+    field.randomFill(0.5f);
+    if (field.getSettings().fixedPointEnergy) field.roundEnergy();
+
+    for (int epoch = 0; epoch < configuration.warmUpEpochs; ++ epoch)
+        field.update();
+
+    uint64_t allocations = 0;
+    bool pruned = false;
+    for (int epoch = 0; epoch < configuration.checkedEpochs; ++ epoch) {
+        int phylogenySize = field.getSpeciesStore().getPhylogeny().getSize();
+        AllocationCounter counter;
+        field.update();
+        allocations += counter.getCount();
+        bool pruning = field.getSpeciesStore().getPhylogeny().getSize() < phylogenySize;
+        pruned |= pruning;
+
+        if (pruning && counter.getCount() > 0) {
+            cerr << configuration.name << ": epoch " << configuration.warmUpEpochs + epoch 
+                 << " pruned the phylogeny with " << counter.getCount() << " allocations" << endl;
+            return false;
+        }
+        if (configuration.maxAllocations == 0 && allocations > 0) {
+            cerr << configuration.name << ": epoch " << configuration.warmUpEpochs + epoch 
+                 << " made " << allocations << " allocations" << endl;
+            return false;
+        }
+    }
+
+    if (allocations > configuration.maxAllocations) {
+        cerr << configuration.name << ": " << allocations << " allocations in " 
+             << configuration.checkedEpochs << " epochs, at most " 
+             << configuration.maxAllocations << " expected" << endl;
+        return false;
+    }
+    if (configuration.prunes && !pruned) {
+        cerr << configuration.name << ": the phylogeny wasn't pruned, the check doesn't cover it" 
+             << endl;
+        return false;
+    }
+    cout << configuration.name << ": " << allocations << " allocations in " 
+         << configuration.checkedEpochs << " epochs" << endl;
+    return true;
+}
+
+// runs the named configuration, or all of them in this process if no name is given
+int main(int argc, char** argv) {
+    if (!AllocationCounter::isEnabled()) {
+        cerr << "build with COUNT_ALLOCATIONS to count allocations" << endl;
+        return EXIT_FAILURE;
+    }
+
+    bool passed = true;
+    bool found = false;
+    for (const Configuration& configuration : CONFIGURATIONS) {
+        if (argc > 1 && string_view{argv[1]} != configuration.name) continue;
+        found = true;
+        passed &= check(configuration);
+    }
+    if (!found) {
+        cerr << "unknown configuration " << argv[1] << endl;
+        return EXIT_FAILURE;
+    }
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}